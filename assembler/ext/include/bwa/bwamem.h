@@ -11,6 +11,8 @@
 struct __smem_i;
 typedef struct __smem_i smem_i;
 
+struct mem_aln_s;
+
 #define MEM_F_PE        0x2
 #define MEM_F_NOPAIRING 0x4
 #define MEM_F_ALL       0x8
@@ -52,6 +54,9 @@ typedef struct mem_opt_s {
 	int max_matesw;         // perform maximally max_matesw rounds of mate-SW for each end
 	int max_XA_hits, max_XA_hits_alt; // if there are max_hits or fewer, output them all
 	int8_t mat[25];         // scoring matrix; mat[0] == 0 if unset
+	// if set, every alignment record is passed to aln_handler instead of being written to bseq1_t::sam
+	void (*aln_handler)(void *data, const bseq1_t *s, const struct mem_aln_s *p, int which);
+	void *aln_handler_data;
 } mem_opt_t;
 
 typedef struct {
@@ -82,7 +87,7 @@ typedef struct {
 	double avg, std; // mean and stddev of the insert size distribution
 } mem_pestat_t;
 
-typedef struct { // This struct is only used for the convenience of API.
+typedef struct mem_aln_s { // This struct is only used for the convenience of API.
 	int64_t pos;     // forward strand 5'-end mapping position
 	int rid;         // reference sequence index in bntseq_t; <0 for unmapped
 	int flag;        // extra flag
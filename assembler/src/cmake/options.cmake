@@ -41,6 +41,12 @@ if (SPADES_STATIC_BUILD)
   set(Boost_USE_STATIC_RUNTIME     ON)
 endif()
 
+# Define option for hashing k-mers of the graph edge index with rolling hash
+option(SPADES_ROLLING_KMER_HASH "Index graph k-mers by rolling hash" OFF)
+if (SPADES_ROLLING_KMER_HASH)
+  add_definitions(-DSPADES_ROLLING_KMER_HASH)
+endif()
+
 # Define minimum and maximum K
 set(SPADES_MIN_K 1 CACHE INTEGER "Minimum k-mer length")
 set(SPADES_MAX_K 128 CACHE INTEGER "Maximum k-mer length")
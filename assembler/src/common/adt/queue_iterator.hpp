@@ -10,6 +10,9 @@
 
 #include "utils/verify.hpp"
 #include <set>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 
 template<typename T, typename Comparator>
 class erasable_priority_queue {
@@ -68,13 +71,140 @@ public:
 
 };
 
-template<typename T, typename Comparator = std::less<T>>
+/*
+ * Alternative to erasable_priority_queue backed by an implicit 4-ary heap in a vector.
+ * Positions of the elements in the heap are indexed, so erase removes an element at once
+ * and the comparator is never called for elements that are not in the queue (e.g. deleted edges).
+ * Neither push nor erase allocate tree nodes. The order of elements is the same as for
+ * erasable_priority_queue provided that Comparator is a strict total order (e.g. ties are
+ * broken by ids) and keys of the elements do not change while they are in the queue.
+ */
+template<typename T, typename Comparator, typename Hash = std::hash<T>>
+class erasable_heap_queue {
+private:
+    static const size_t ARITY = 4;
+
+    std::vector<T> heap_;
+    std::unordered_map<T, size_t, Hash> pos_;
+    Comparator comparator_;
+
+    void Place(size_t pos, const T &key) {
+        heap_[pos] = key;
+        pos_[key] = pos;
+    }
+
+    void SiftUp(size_t pos) {
+        T key = heap_[pos];
+        while (pos > 0) {
+            size_t parent = (pos - 1) / ARITY;
+            if (!comparator_(key, heap_[parent]))
+                break;
+            Place(pos, heap_[parent]);
+            pos = parent;
+        }
+        Place(pos, key);
+    }
+
+    void SiftDown(size_t pos) {
+        T key = heap_[pos];
+        size_t size = heap_.size();
+        while (true) {
+            size_t first = pos * ARITY + 1;
+            if (first >= size)
+                break;
+            size_t best = first;
+            for (size_t child = first + 1; child < std::min(first + ARITY, size); ++child) {
+                if (comparator_(heap_[child], heap_[best]))
+                    best = child;
+            }
+            if (!comparator_(heap_[best], key))
+                break;
+            Place(pos, heap_[best]);
+            pos = best;
+        }
+        Place(pos, key);
+    }
+
+    //removes the element at position pos, the last element takes its place
+    void RemoveAt(size_t pos) {
+        pos_.erase(heap_[pos]);
+        T last = heap_.back();
+        heap_.pop_back();
+        if (pos == heap_.size())
+            return;
+        Place(pos, last);
+        if (pos > 0 && comparator_(last, heap_[(pos - 1) / ARITY]))
+            SiftUp(pos);
+        else
+            SiftDown(pos);
+    }
+
+public:
+    erasable_heap_queue(const Comparator& comparator = Comparator()) :
+        comparator_(comparator) {
+    }
+
+    template<typename InputIterator>
+    erasable_heap_queue(InputIterator begin, InputIterator end,
+            const Comparator& comparator = Comparator()) :
+        comparator_(comparator) {
+        insert(begin, end);
+    }
+
+    void pop() {
+        VERIFY(!heap_.empty());
+        RemoveAt(0);
+    }
+
+    const T& top() const {
+        VERIFY(!heap_.empty());
+        return heap_[0];
+    }
+
+    void push(const T& key) {
+        if (!pos_.insert(std::make_pair(key, heap_.size())).second)
+            return;
+        heap_.push_back(key);
+        SiftUp(heap_.size() - 1);
+    }
+
+    bool erase(const T& key) {
+        auto it = pos_.find(key);
+        if (it == pos_.end())
+            return false;
+        RemoveAt(it->second);
+        return true;
+    }
+
+    void clear() {
+        heap_.clear();
+        pos_.clear();
+    }
+
+    bool empty() const {
+        return heap_.empty();
+    }
+
+    size_t size() const {
+        return heap_.size();
+    }
+
+    template <class InputIterator>
+    void insert ( InputIterator first, InputIterator last ) {
+        for (auto it = first; it != last; ++it)
+            push(*it);
+    }
+
+};
+
+template<typename T, typename Comparator = std::less<T>,
+         typename Queue = erasable_priority_queue<T, Comparator>>
 class DynamicQueueIterator {
 
     bool current_actual_;
     bool current_deleted_;
     T current_;
-    erasable_priority_queue<T, Comparator> queue_;
+    Queue queue_;
 
 public:
 
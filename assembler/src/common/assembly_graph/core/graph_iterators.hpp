@@ -19,11 +19,13 @@ namespace omnigraph {
  * SmartIterator is able to iterate through collection content of which can be changed in process of
  * iteration. And as GraphActionHandler SmartIterator can change collection contents with respect to the
  * way graph is changed. Also one can define order of iteration by specifying Comparator.
+ * Queue defines the backing storage, see erasable_priority_queue and erasable_heap_queue.
  */
-template<class Graph, typename ElementId, typename Comparator = std::less<ElementId>>
+template<class Graph, typename ElementId, typename Comparator = std::less<ElementId>,
+         typename Queue = erasable_priority_queue<ElementId, Comparator>>
 class SmartIterator : public GraphActionHandler<Graph> {
     typedef GraphActionHandler<Graph> base;
-    DynamicQueueIterator<ElementId, Comparator> inner_it_;
+    DynamicQueueIterator<ElementId, Comparator, Queue> inner_it_;
     bool add_new_;
     bool canonical_only_;
     //todo think of checking it in HandleAdd
@@ -110,9 +112,10 @@ public:
  * way graph is changed. Also one can define order of iteration by specifying Comparator.
  */
 template<class Graph, typename ElementId,
-         typename Comparator = std::less<ElementId>>
-class SmartSetIterator : public SmartIterator<Graph, ElementId, Comparator> {
-    typedef SmartIterator<Graph, ElementId, Comparator> base;
+         typename Comparator = std::less<ElementId>,
+         typename Queue = erasable_priority_queue<ElementId, Comparator>>
+class SmartSetIterator : public SmartIterator<Graph, ElementId, Comparator, Queue> {
+    typedef SmartIterator<Graph, ElementId, Comparator, Queue> base;
 
 public:
     SmartSetIterator(const Graph &g,
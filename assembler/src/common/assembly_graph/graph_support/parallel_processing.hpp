@@ -12,6 +12,8 @@
 #include "assembly_graph/graph_support/graph_processing_algorithm.hpp"
 #include "utils/openmp_wrapper.h"
 
+#include <unordered_set>
+
 namespace omnigraph {
 
 template<class ItVec, class Condition, class Handler>
@@ -117,6 +119,60 @@ private:
     DECL_LOGGER("ParallelInterestingElementFinder");
 };
 
+/*
+ * Collects vertices that got their sets of incident edges changed and deleted elements
+ * while attached to the graph.
+ */
+template<class Graph>
+class ModifiedNeighbourhoodTracker : public GraphActionHandler<Graph> {
+    typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+
+    std::unordered_set<VertexId> modified_vertices_;
+    std::unordered_set<VertexId> deleted_vertices_;
+    std::unordered_set<EdgeId> deleted_edges_;
+
+public:
+    ModifiedNeighbourhoodTracker(const Graph &g)
+            : GraphActionHandler<Graph>(g, "ModifiedNeighbourhoodTracker") {
+    }
+
+    void HandleDelete(EdgeId e) override {
+        modified_vertices_.insert(this->g().EdgeStart(e));
+        modified_vertices_.insert(this->g().EdgeEnd(e));
+        deleted_edges_.insert(e);
+    }
+
+    void HandleDelete(VertexId v) override {
+        deleted_vertices_.insert(v);
+    }
+
+    bool IsDeleted(EdgeId e) const {
+        return deleted_edges_.count(e);
+    }
+
+    bool IsDeleted(VertexId v) const {
+        return deleted_vertices_.count(v);
+    }
+
+    //Edges incident to some end of e changed
+    bool IsAffected(EdgeId e) const {
+        return modified_vertices_.count(this->g().EdgeStart(e)) ||
+               modified_vertices_.count(this->g().EdgeEnd(e));
+    }
+
+    //Edges incident to v changed
+    bool IsAffected(VertexId v) const {
+        return modified_vertices_.count(v);
+    }
+
+    void clear() {
+        modified_vertices_.clear();
+        deleted_vertices_.clear();
+        deleted_edges_.clear();
+    }
+};
+
 template<class Graph>
 class PersistentAlgorithmBase {
     Graph& g_;
@@ -144,18 +200,71 @@ inline size_t LoopedRun(Algo& algo) {
 }
 
 //todo only potentially relevant edges should be stored at any point
+//Queue can be switched to erasable_heap_queue when keys of the queued elements do not change
 template<class Graph, class ElementId,
-         class Comparator = std::less<ElementId>>
+         class Comparator = std::less<ElementId>,
+         class Queue = erasable_priority_queue<ElementId, Comparator>>
 class PersistentProcessingAlgorithm : public PersistentAlgorithmBase<Graph> {
 protected:
     typedef std::shared_ptr<InterestingElementFinder<Graph, ElementId>> CandidateFinderPtr;
     CandidateFinderPtr interest_el_finder_;
 
 private:
-    SmartSetIterator<Graph, ElementId, Comparator> it_;
+    SmartSetIterator<Graph, ElementId, Comparator, Queue> it_;
     bool tracking_;
     size_t total_iteration_estimate_;
     size_t curr_iteration_;
+    size_t buff_size_;
+
+    //Candidates are checked concurrently in buffers of buff_size_ elements and processed on a single thread
+    //in the order of the queue. Processing of the preceding candidates of the buffer can change
+    //the neighbourhood of the candidate, then it is checked again. Check has to depend only on the element
+    //and the elements incident to its ends.
+    size_t ProcessBuffered() {
+        size_t triggered = 0;
+        ModifiedNeighbourhoodTracker<Graph> tracker(this->g());
+        std::vector<ElementId> buffer;
+        buffer.reserve(buff_size_);
+        bool proceed = true;
+        while (proceed && !it_.IsEnd()) {
+            buffer.clear();
+            for (; !it_.IsEnd() && buffer.size() < buff_size_; ++it_) {
+                ElementId el = *it_;
+                if (!Proceed(el)) {
+                    TRACE("Proceed condition turned false on element " << this->g().str(el));
+                    it_.ReleaseCurrent();
+                    proceed = false;
+                    break;
+                }
+                buffer.push_back(el);
+            }
+
+            std::vector<char> checked(buffer.size());
+            #pragma omp parallel for schedule(guided)
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                checked[i] = Check(buffer[i]);
+            }
+
+            tracker.clear();
+            size_t rechecked = 0;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                ElementId el = buffer[i];
+                if (tracker.IsDeleted(el))
+                    continue;
+                if (!tracker.IsAffected(el)) {
+                    if (checked[i] && ProcessChecked(el))
+                        triggered++;
+                } else {
+                    TRACE("Neighbourhood of " << this->g().str(el) << " changed, checking again");
+                    rechecked++;
+                    if (Process(el))
+                        triggered++;
+                }
+            }
+            DEBUG("Processed buffer of " << buffer.size() << " elements, " << rechecked << " checked again");
+        }
+        return triggered;
+    }
 
 protected:
     void ReturnForConsideration(ElementId el) {
@@ -165,6 +274,11 @@ protected:
     virtual bool Process(ElementId el) = 0;
     virtual bool Proceed(ElementId /*el*/) const { return true; }
 
+    //Should not modify the graph, used to check candidates concurrently when buffering is enabled
+    virtual bool Check(ElementId /*el*/) const { return true; }
+    //Processes element that passed Check without changes in its neighbourhood since then
+    virtual bool ProcessChecked(ElementId el) { return Process(el); }
+
     virtual void PrepareIteration(size_t /*it_cnt*/, size_t /*total_it_estimate*/) {}
 
 public:
@@ -174,13 +288,15 @@ public:
                                   bool canonical_only = false,
                                   const Comparator& comp = Comparator(),
                                   bool track_changes = true,
-                                  size_t total_iteration_estimate = -1ul) :
+                                  size_t total_iteration_estimate = -1ul,
+                                  size_t buff_size = 0) :
             PersistentAlgorithmBase<Graph>(g),
             interest_el_finder_(interest_el_finder),
             it_(g, true, comp, canonical_only),
             tracking_(track_changes),
             total_iteration_estimate_(total_iteration_estimate),
-            curr_iteration_(0) {
+            curr_iteration_(0),
+            buff_size_(buff_size) {
         it_.Detach();
     }
 
@@ -204,16 +320,20 @@ public:
 
         size_t triggered = 0;
         TRACE("Start processing");
-        for (; !it_.IsEnd(); ++it_) {
-            ElementId el = *it_;
-            if (!Proceed(el)) {
-                TRACE("Proceed condition turned false on element " << this->g().str(el));
-                it_.ReleaseCurrent();
-                break;
+        if (buff_size_ > 0) {
+            triggered = ProcessBuffered();
+        } else {
+            for (; !it_.IsEnd(); ++it_) {
+                ElementId el = *it_;
+                if (!Proceed(el)) {
+                    TRACE("Proceed condition turned false on element " << this->g().str(el));
+                    it_.ReleaseCurrent();
+                    break;
+                }
+                TRACE("Processing edge " << this->g().str(el));
+                if (Process(el))
+                    triggered++;
             }
-            TRACE("Processing edge " << this->g().str(el));
-            if (Process(el))
-                triggered++;
         }
         TRACE("Finished processing. Triggered = " << triggered);
         if (!tracking_)
@@ -227,12 +347,13 @@ private:
 };
 
 template<class Graph,
-        class Comparator = std::less<typename Graph::EdgeId>>
+        class Comparator = std::less<typename Graph::EdgeId>,
+        class Queue = erasable_priority_queue<typename Graph::EdgeId, Comparator>>
 class ParallelEdgeRemovingAlgorithm : public PersistentProcessingAlgorithm<Graph,
         typename Graph::EdgeId,
-        Comparator> {
+        Comparator, Queue> {
     typedef typename Graph::EdgeId EdgeId;
-    typedef PersistentProcessingAlgorithm<Graph, EdgeId, Comparator> base;
+    typedef PersistentProcessingAlgorithm<Graph, EdgeId, Comparator, Queue> base;
 
     const func::TypedPredicate<EdgeId> remove_condition_;
     EdgeRemover<Graph> edge_remover_;
@@ -250,6 +371,16 @@ protected:
         return false;
     }
 
+    bool Check(EdgeId e) const override {
+        return remove_condition_(e);
+    }
+
+    bool ProcessChecked(EdgeId e) override {
+        TRACE("Removing checked edge " << this->g().str(e));
+        edge_remover_.DeleteEdge(e);
+        return true;
+    }
+
 public:
     ParallelEdgeRemovingAlgorithm(Graph& g,
                                   func::TypedPredicate<EdgeId> remove_condition,
@@ -257,10 +388,11 @@ public:
                                   std::function<void(EdgeId)> removal_handler = boost::none,
                                   bool canonical_only = false,
                                   const Comparator& comp = Comparator(),
-                                  bool track_changes = true)
+                                  bool track_changes = true,
+                                  size_t buff_size = 0)
             : base(g,
                    std::make_shared<ParallelInterestingElementFinder<Graph>>(remove_condition, chunk_cnt),
-                   canonical_only, comp, track_changes),
+                   canonical_only, comp, track_changes, /*total_iteration_estimate*/-1ul, buff_size),
                    remove_condition_(remove_condition),
                    edge_remover_(g, removal_handler) {
     }
@@ -17,6 +17,8 @@
 
 //#include "utils.hpp"
 #include "utils/simple_tools.hpp"
+#include <unordered_map>
+#include <algorithm>
 #include "assembly_graph/paths/mapping_path.hpp"
 #include "assembly_graph/core/action_handlers.hpp"
 
@@ -36,53 +38,131 @@ inline ostream& operator <<(ostream& os, const EdgePosition& ep) {
     return os << ep.contigId << " " << ep.mr;
 }
 
+/*
+ * Positions are stored per edge as a flat vector of (contig, range) entries sorted
+ * by interned contig id and then by range, so that every contig occupies a contiguous
+ * segment with the same ordering std::set<MappingRange> used to provide.
+ */
 template<class Graph>
 class EdgesPositionHandler: public GraphActionHandler<Graph> {
     typedef typename Graph::VertexId VertexId;
     typedef typename Graph::EdgeId EdgeId;
 
+    struct PositionEntry {
+        uint32_t contig;
+        MappingRange mr;
+
+        PositionEntry(uint32_t contig, const MappingRange &mr) : contig(contig), mr(mr) {
+        }
+
+        bool operator<(const PositionEntry &other) const {
+            if (contig != other.contig)
+                return contig < other.contig;
+            return mr < other.mr;
+        }
+    };
+
+    typedef std::vector<PositionEntry> PositionStorage;
+
+    struct ContigLess {
+        bool operator()(const PositionEntry &entry, uint32_t contig) const {
+            return entry.contig < contig;
+        }
+
+        bool operator()(uint32_t contig, const PositionEntry &entry) const {
+            return contig < entry.contig;
+        }
+    };
+
     size_t max_mapping_gap_;
     size_t max_gap_diff_;
-    map<EdgeId, map<string, std::set<MappingRange>>> edges_positions_;
-    //TODO extract set<MappingRange> as a storage class
+    std::vector<std::string> contig_names_;
+    std::unordered_map<std::string, uint32_t> contig_ids_;
+    std::unordered_map<EdgeId, PositionStorage> edges_positions_;
+
+    uint32_t ContigId(const std::string &contig_name) {
+        auto it = contig_ids_.find(contig_name);
+        if (it != contig_ids_.end())
+            return it->second;
+        uint32_t id = uint32_t(contig_names_.size());
+        contig_names_.push_back(contig_name);
+        contig_ids_.insert(std::make_pair(contig_name, id));
+        return id;
+    }
 
-    MappingRange EraseAndExtract(set<MappingRange> &ranges, set<MappingRange>::iterator &position, const MappingRange &new_pos) {
-        auto &old_pos = *position;
+    MappingRange EraseAndExtract(PositionStorage &positions, typename PositionStorage::iterator position,
+                                 const MappingRange &new_pos) const {
+        MappingRange old_pos = position->mr;
         if(old_pos.IntersectLeftOf(new_pos) || old_pos.StrictlyContinuesWith(new_pos, max_mapping_gap_, max_gap_diff_)) {
-            ranges.erase(position);
+            positions.erase(position);
             return old_pos.Merge(new_pos);
         } else if(new_pos.IntersectLeftOf(old_pos) || new_pos.StrictlyContinuesWith(old_pos, max_mapping_gap_, max_gap_diff_)) {
-            ranges.erase(position);
+            positions.erase(position);
             return new_pos.Merge(old_pos);
         } else {
             return new_pos;
         }
     }
 
-public:
-    MappingRange EraseAndExtract(set<MappingRange> &ranges, MappingRange new_pos) {
-        auto it = ranges.lower_bound(new_pos);
-        if(it != ranges.end()) {
-            new_pos = EraseAndExtract(ranges, it, new_pos);
-            it = ranges.lower_bound(new_pos);
+    void InsertPosition(PositionStorage &positions, uint32_t contig, MappingRange new_pos) const {
+        if(new_pos.empty())
+            return;
+        auto it = std::lower_bound(positions.begin(), positions.end(), PositionEntry(contig, new_pos));
+        if(it != positions.end() && it->contig == contig) {
+            new_pos = EraseAndExtract(positions, it, new_pos);
+            it = std::lower_bound(positions.begin(), positions.end(), PositionEntry(contig, new_pos));
+        }
+        if(it != positions.begin() && std::prev(it)->contig == contig) {
+            new_pos = EraseAndExtract(positions, std::prev(it), new_pos);
         }
-        if(it != ranges.begin()) {
-            new_pos = EraseAndExtract(ranges, --it, new_pos);
+        PositionEntry entry(contig, new_pos);
+        it = std::lower_bound(positions.begin(), positions.end(), entry);
+        if(it == positions.end() || entry < *it)
+            positions.insert(it, entry);
+    }
+
+    void AddEdgePositions(EdgeId edge, const PositionStorage &positions) {
+        if (positions.empty())
+            return;
+        PositionStorage &new_positions = edges_positions_[edge];
+        for(const auto &entry : positions) {
+            InsertPosition(new_positions, entry.contig, entry.mr);
+        }
+    }
+
+    void AddAndShiftEdgePositions(EdgeId edge, const PositionStorage &positions, int shift = 0) {
+        if (positions.empty())
+            return;
+        size_t length = this->g().length(edge);
+        PositionStorage &new_positions = edges_positions_[edge];
+        for(const auto &entry : positions) {
+            InsertPosition(new_positions, entry.contig, entry.mr.Shift(shift).Fit(length));
         }
-        return new_pos;
     }
 
+    //positions of the old edges are left in place, HandleDelete erases them
+    PositionStorage CopyPositions(EdgeId edge) const {
+        auto it = edges_positions_.find(edge);
+        if (it == edges_positions_.end())
+            return PositionStorage();
+        return it->second;
+    }
+
+public:
     set<MappingRange> GetEdgePositions(EdgeId edge, string contig_id) const {
         VERIFY(this->IsAttached());
         auto edge_it = edges_positions_.find(edge);
         if(edge_it == edges_positions_.end())
             return set<MappingRange>();
-        const auto& positions = edge_it->second;
-        auto it = positions.find(contig_id);
-        if(it == positions.end())
+        auto id_it = contig_ids_.find(contig_id);
+        if(id_it == contig_ids_.end())
             return set<MappingRange>();
-        else
-            return it->second;
+        auto range = std::equal_range(edge_it->second.begin(), edge_it->second.end(),
+                                      id_it->second, ContigLess());
+        set<MappingRange> result;
+        for(auto it = range.first; it != range.second; ++it)
+            result.insert(result.end(), it->mr);
+        return result;
     }
 
     vector<EdgePosition> GetEdgePositions(EdgeId edge) const {
@@ -91,11 +171,14 @@ public:
         if(edge_it == edges_positions_.end())
             return vector<EdgePosition>();
         vector<EdgePosition> result;
-        for(auto it = edge_it->second.begin(); it != edge_it->second.end(); ++it) {
-            for(auto pos_it = it->second.begin(); pos_it != it->second.end(); ++pos_it) {
-                result.push_back(EdgePosition(it->first, *pos_it));
-            }
+        result.reserve(edge_it->second.size());
+        for(const auto &entry : edge_it->second) {
+            result.push_back(EdgePosition(contig_names_[entry.contig], entry.mr));
         }
+        //contigs are reported in the name order
+        std::stable_sort(result.begin(), result.end(), [](const EdgePosition &a, const EdgePosition &b) {
+            return a.contigId < b.contigId;
+        });
         return result;
     }
 
@@ -108,18 +191,7 @@ public:
         VERIFY(this->IsAttached());
         if(new_pos.empty())
             return;
-        set<MappingRange> &new_set = edges_positions_[edge][contig_id];
-        new_pos = EraseAndExtract(new_set, new_pos);
-        new_set.insert(new_pos);
-    }
-
-    void AddAndShiftEdgePositions(EdgeId edge, const map<string, set<MappingRange>> &contig_map, int shift = 0) {
-        VERIFY(this->IsAttached());
-        for(auto contig_it = contig_map.begin(); contig_it != contig_map.end(); ++contig_it) {
-            for(auto it = contig_it->second.begin(); it != contig_it->second.end(); ++it) {
-                AddEdgePosition(edge, contig_it->first, it->Shift(shift).Fit(this->g().length(edge)));
-            }
-        }
+        InsertPosition(edges_positions_[edge], ContigId(contig_id), new_pos);
     }
 
     template<typename Iter>
@@ -164,10 +236,8 @@ public:
 
     virtual void HandleGlue(EdgeId new_edge, EdgeId edge1, EdgeId edge2) {
 //        TRACE("Handle glue ");
-        auto positions1 = GetEdgePositions(edge1);
-        auto positions2 = GetEdgePositions(edge2);
-        AddEdgePositions(new_edge, positions1.begin(), positions1.end());
-        AddEdgePositions(new_edge, positions2.begin(), positions2.end());
+        AddEdgePositions(new_edge, CopyPositions(edge1));
+        AddEdgePositions(new_edge, CopyPositions(edge2));
     }
 
     virtual void HandleSplit(EdgeId oldEdge, EdgeId newEdge1, EdgeId newEdge2) {
@@ -175,18 +245,17 @@ public:
             WARN("EdgesPositionHandler does not support self-conjugate splits");
             return;
         }
-        if (edges_positions_.count(oldEdge) != 0) {
-            auto contig_map = edges_positions_[oldEdge];
-            AddAndShiftEdgePositions(newEdge1, contig_map, 0);
-            AddAndShiftEdgePositions(newEdge2, contig_map, -int(this->g().length(newEdge1)));
-        }
+        PositionStorage positions = CopyPositions(oldEdge);
+        AddAndShiftEdgePositions(newEdge1, positions, 0);
+        AddAndShiftEdgePositions(newEdge2, positions, -int(this->g().length(newEdge1)));
     }
 
     virtual void HandleMerge(const vector<EdgeId>& oldEdges, EdgeId newEdge) {
         int shift = 0;
         for(auto it = oldEdges.begin(); it != oldEdges.end(); ++it) {
-            if (edges_positions_.count(*it) != 0) {
-                AddAndShiftEdgePositions(newEdge, edges_positions_[*it], shift);
+            auto pos_it = edges_positions_.find(*it);
+            if (pos_it != edges_positions_.end()) {
+                AddAndShiftEdgePositions(newEdge, pos_it->second, shift);
             }
             shift += int(this->g().length(*it));
         }
@@ -201,6 +270,8 @@ public:
 
     void clear() {
         edges_positions_.clear();
+        contig_ids_.clear();
+        contig_names_.clear();
     }
 
 private:
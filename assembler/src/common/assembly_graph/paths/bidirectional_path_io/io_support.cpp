@@ -64,11 +64,11 @@ void path_extend::TranscriptToGeneJoiner::Construct(const PathContainer &paths)
     GraphCoverageMap edges_coverage(g_, paths);
 
     DEBUG("Union trees");
-    //For all edges in coverage map
-    for (auto iterator = edges_coverage.begin(); iterator != edges_coverage.end(); ++iterator) {
+    //For all edges of the graph, the order determines which path represents a gene and hence gene ids
+    for (auto iterator = g_.ConstEdgeBegin(); !iterator.IsEnd(); ++iterator) {
         //Select a path covering an edge
-        EdgeId edge = iterator->first;
-        GraphCoverageMap::MapDataT *edge_paths = iterator->second;
+        EdgeId edge = *iterator;
+        const GraphCoverageMap::MapDataT *edge_paths = edges_coverage.GetEdgePaths(edge);
 
         if (g_.length(edge) > min_edge_len_ && edge_paths->size() > 1) {
             DEBUG("Long edge " << edge.int_id() << " Paths " << edge_paths->size());
@@ -28,6 +28,12 @@
 
 #include <zlib.h>
 #include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "kseq/kseq.h"
 #include "utils/verify.hpp"
 #include "single_read.hpp"
@@ -42,6 +48,10 @@ namespace fastafastqgz {
 KSEQ_INIT(gzFile, gzread)
 }
 
+/*
+ * Decompression and parsing are performed by the dedicated read-ahead thread,
+ * which fills reusable batches of records while the consumer builds SingleReads.
+ */
 class FastaFastqGzParser: public Parser {
 public:
     /*
@@ -52,7 +62,8 @@ public:
      */
     FastaFastqGzParser(const std::string& filename, OffsetType offset_type =
             PhredOffset) :
-            Parser(filename, offset_type), fp_(), seq_(NULL) {
+            Parser(filename, offset_type), fp_(), seq_(NULL),
+            stop_(false), reader_done_(false), pos_(0) {
         open();
     }
 
@@ -76,22 +87,16 @@ public:
         if (!is_open_ || eof_) {
             return *this;
         }
+        const Record& record = current_->records[pos_++];
         //todo offset_type_ should be used in future
-        if (seq_->qual.s) {
-            read = SingleRead(seq_->name.s, seq_->seq.s, seq_->qual.s, offset_type_);
+        if (record.has_qual) {
+            read = SingleRead(record.name, record.seq, record.qual, offset_type_);
         } else {
-            read = SingleRead(seq_->name.s, seq_->seq.s);
-//            size_t len = strlen(seq_->seq.s);
-//            char* qual = (char*) malloc(len + 1);
-//            char q = '\2' + 64;
-//            for (size_t i = 0; i < len; ++i) {
-//                qual[i] = q;
-//            }
-//            qual[len] = '\0';
-//            read.SetAll(seq_->name.s, seq_->seq.s, qual, SolexaOffset);
-//            free(qual);
+            read = SingleRead(record.name, record.seq);
+        }
+        if (pos_ == current_->size) {
+            FetchBatch();
         }
-        ReadAhead();
         return *this;
     }
 
@@ -101,6 +106,15 @@ public:
     /* virtual */
     void close() {
         if (is_open_) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            reader_.join();
+            full_.clear();
+            free_.clear();
+            current_.reset();
             // STEP 5: destroy seq
             fastafastqgz::kseq_destroy(seq_);
             // STEP 6: close the file handler
@@ -111,16 +125,47 @@ public:
     }
 
 private:
+    struct Record {
+        std::string name;
+        std::string seq;
+        std::string qual;
+        bool has_qual;
+    };
+
+    struct Batch {
+        std::vector<Record> records;
+        size_t size;
+
+        Batch(size_t capacity) : records(capacity), size(0) {}
+    };
+
+    static const size_t kBatchSize = 1 << 12;
+    //number of batches which can be filled ahead of the consumer
+    static const size_t kQueueSize = 4;
+
     /*
      * @variable File that is associated with gzipped data file.
      */
     gzFile fp_;
     /*
-     * @variable Data element that stores last SingleRead got from
-     * stream.
+     * @variable kseq state, owned by the read-ahead thread while the stream is open.
      */
     fastafastqgz::kseq_t* seq_;
 
+    std::thread reader_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Batch>> full_;
+    std::vector<std::unique_ptr<Batch>> free_;
+    bool stop_;
+    bool reader_done_;
+
+    /*
+     * @variable Batch currently consumed and position of the next record in it.
+     */
+    std::unique_ptr<Batch> current_;
+    size_t pos_;
+
     /*
      * Open a stream.
      */
@@ -132,20 +177,84 @@ private:
             is_open_ = false;
             return;
         }
+        gzbuffer(fp_, 1 << 20);
         // STEP 3: initialize seq
         seq_ = fastafastqgz::kseq_init(fp_);
+        for (size_t i = 0; i <= kQueueSize; ++i) {
+            free_.emplace_back(new Batch(kBatchSize));
+        }
+        stop_ = false;
+        reader_done_ = false;
         eof_ = false;
         is_open_ = true;
-        ReadAhead();
+        reader_ = std::thread(&FastaFastqGzParser::ReadAheadLoop, this);
+        FetchBatch();
+    }
+
+    bool FillBatch(Batch& batch) {
+        batch.size = 0;
+        while (batch.size < batch.records.size()) {
+            // STEP 4: read sequence
+            if (fastafastqgz::kseq_read(seq_) < 0) {
+                return false;
+            }
+            Record& record = batch.records[batch.size++];
+            record.name.assign(seq_->name.s);
+            record.seq.assign(seq_->seq.s);
+            record.has_qual = (seq_->qual.s != NULL);
+            if (record.has_qual) {
+                record.qual.assign(seq_->qual.s);
+            }
+        }
+        return true;
     }
 
     /*
-     * Read next SingleRead from file.
+     * Body of the read-ahead thread.
      */
-    void ReadAhead() {
+    void ReadAheadLoop() {
+        bool more = true;
+        while (more) {
+            std::unique_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !free_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                batch = std::move(free_.back());
+                free_.pop_back();
+            }
+            more = FillBatch(*batch);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                full_.push_back(std::move(batch));
+                reader_done_ = !more;
+            }
+            cv_.notify_all();
+        }
+    }
+
+    /*
+     * Return consumed batch for reuse and wait for the next one.
+     */
+    void FetchBatch() {
         VERIFY(is_open_);
         VERIFY(!eof_);
-        if (fastafastqgz::kseq_read(seq_) < 0) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (current_) {
+            free_.push_back(std::move(current_));
+            cv_.notify_all();
+        }
+        cv_.wait(lock, [this] { return !full_.empty() || reader_done_; });
+        if (full_.empty()) {
+            eof_ = true;
+            return;
+        }
+        current_ = std::move(full_.front());
+        full_.pop_front();
+        pos_ = 0;
+        if (current_->size == 0) {
             eof_ = true;
         }
     }
@@ -11,6 +11,7 @@
 #include "bwa/utils.h"
 #include "kseq/kseq.h"
 
+#include <functional>
 #include <string>
 #include <memory>
 
@@ -37,6 +38,8 @@ BWAIndex::BWAIndex(const debruijn_graph::Graph& g)
 
 BWAIndex::~BWAIndex() {}
 
+typedef std::function<std::string(size_t)> SequenceGetter;
+
 // modified from bwa (heng li)
 static uint8_t* seqlib_add1(const kstring_t *seq, const kstring_t *name,
                             bntseq_t *bns, uint8_t *pac, int64_t *m_pac, int *m_seqs, int *m_holes, bntamb1_t **q) {
@@ -87,8 +90,8 @@ static uint8_t* seqlib_add1(const kstring_t *seq, const kstring_t *name,
     return pac;
 }
 
-static uint8_t* seqlib_make_pac(const debruijn_graph::Graph &g,
-                                const std::vector<debruijn_graph::EdgeId> &ids,
+static uint8_t* seqlib_make_pac(size_t n,
+                                const SequenceGetter &get_name, const SequenceGetter &get_seq,
                                 bool for_only) {
     bntseq_t * bns = (bntseq_t*)calloc(1, sizeof(bntseq_t));
     uint8_t *pac = 0;
@@ -105,9 +108,9 @@ static uint8_t* seqlib_make_pac(const debruijn_graph::Graph &g,
 
     // move through the sequences
     // FIXME: not kstring is required
-    for (auto e : ids) {
-        std::string ref = std::to_string(g.int_id(e));
-        std::string seq = g.EdgeNucls(e).str();
+    for (size_t i = 0; i < n; ++i) {
+        std::string ref = get_name(i);
+        std::string seq = get_seq(i);
 
         // make the ref name kstring
         kstring_t * name = (kstring_t*)malloc(1 * sizeof(kstring_t));
@@ -196,23 +199,19 @@ static bntann1_t* seqlib_add_to_anns(const std::string& name, const std::string&
     return ann;
 }
 
-void BWAIndex::Init() {
-    idx_.reset((bwaidx_t*)calloc(1, sizeof(bwaidx_t)));
-    ids_.clear();
-
-    for (auto it = g_.ConstEdgeBegin(true); !it.IsEnd(); ++it) {
-        ids_.push_back(*it);
-    }
+static bwaidx_t* seqlib_make_idx(size_t n,
+                                  const SequenceGetter &get_name, const SequenceGetter &get_seq) {
+    bwaidx_t *idx = (bwaidx_t*)calloc(1, sizeof(bwaidx_t));
 
     // construct the forward-only pac
-    uint8_t* fwd_pac = seqlib_make_pac(g_, ids_, true); //true->for_only
+    uint8_t* fwd_pac = seqlib_make_pac(n, get_name, get_seq, true); //true->for_only
 
     // construct the forward-reverse pac ("packed" 2 bit sequence)
-    uint8_t* pac = seqlib_make_pac(g_, ids_, false); // don't write, becasue only used to make BWT
+    uint8_t* pac = seqlib_make_pac(n, get_name, get_seq, false); // don't write, becasue only used to make BWT
 
     size_t tlen = 0;
-    for (auto e : ids_)
-        tlen += g_.EdgeNucls(e).size();
+    for (size_t i = 0; i < n; ++i)
+        tlen += get_seq(i).length();
 
 #ifdef DEBUG_BWATOOLS
     std::cerr << "ref seq length: " << tlen << std::endl;
@@ -231,18 +230,18 @@ void BWAIndex::Init() {
     // make the bns
     bntseq_t * bns = (bntseq_t*) calloc(1, sizeof(bntseq_t));
     bns->l_pac = tlen;
-    bns->n_seqs = ids_.size();
+    bns->n_seqs = (int32_t)n;
     bns->seed = 11;
     bns->n_holes = 0;
 
     // make the anns
     // FIXME: Do we really need this?
-    bns->anns = (bntann1_t*)calloc(ids_.size(), sizeof(bntann1_t));
-    size_t offset = 0, k = 0;
-    for (auto e: ids_) {
-        std::string name = std::to_string(g_.int_id(e));
-        std::string seq = g_.EdgeNucls(e).str();
-        seqlib_add_to_anns(name, seq, &bns->anns[k++], offset);
+    bns->anns = (bntann1_t*)calloc(n, sizeof(bntann1_t));
+    size_t offset = 0;
+    for (size_t i = 0; i < n; ++i) {
+        std::string name = get_name(i);
+        std::string seq = get_seq(i);
+        seqlib_add_to_anns(name, seq, &bns->anns[i], offset);
         offset += seq.length();
     }
 
@@ -250,9 +249,31 @@ void BWAIndex::Init() {
     bns->ambs = 0; //(bntamb1_t*)calloc(1, sizeof(bntamb1_t));
 
     // make the in-memory idx struct
-    idx_->bwt = bwt;
-    idx_->bns = bns;
-    idx_->pac = fwd_pac;
+    idx->bwt = bwt;
+    idx->bns = bns;
+    idx->pac = fwd_pac;
+
+    return idx;
+}
+
+void BWAIndex::Init() {
+    ids_.clear();
+
+    for (auto it = g_.ConstEdgeBegin(true); !it.IsEnd(); ++it) {
+        ids_.push_back(*it);
+    }
+
+    idx_.reset(seqlib_make_idx(ids_.size(),
+                               [&](size_t i) { return std::to_string(g_.int_id(ids_[i])); },
+                               [&](size_t i) { return g_.EdgeNucls(ids_[i]).str(); }));
+}
+
+bwaidx_t* BuildBWAIndex(const std::vector<std::string> &names,
+                        const std::vector<std::string> &seqs) {
+    VERIFY(names.size() == seqs.size());
+    return seqlib_make_idx(names.size(),
+                           [&](size_t i) { return names[i]; },
+                           [&](size_t i) { return seqs[i]; });
 }
 
 omnigraph::MappingPath<debruijn_graph::EdgeId> BWAIndex::AlignSequence(const Sequence &sequence) const {
@@ -19,6 +19,12 @@ typedef struct mem_opt_s mem_opt_t;
 
 namespace alignment {
 
+// Builds an in-memory BWA index (forward strand sequences, BWT, SA and
+// annotations) for the given named sequences. The result should be
+// destroyed via bwa_idx_destroy.
+bwaidx_t* BuildBWAIndex(const std::vector<std::string> &names,
+                        const std::vector<std::string> &seqs);
+
 class BWAIndex {
   public:
     // bwaidx / memopt are incomplete below, therefore we need to outline ctor
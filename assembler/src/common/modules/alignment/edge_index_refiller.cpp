@@ -12,7 +12,7 @@
 
 namespace debruijn_graph {
 
-using EdgeIndex = KmerFreeEdgeIndex<ConjugateDeBruijnGraph>;
+using EdgeIndex = KmerFreeEdgeIndex<ConjugateDeBruijnGraph, DefaultStoring, EdgeIndexTraits>;
 
 template<>
 void EdgeIndexRefiller::Refill(EdgeIndex &index,
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <algorithm>
+#include <numeric>
+#include <mutex>
 
 namespace debruijn_graph {
 
@@ -63,103 +65,155 @@ public:
 
 };
 
+/*
+ * Weighted set of edge paths.
+ * All distinct paths are kept in a single edge pool delimited by offsets, weights are stored as floats.
+ * Duplicates are detected via open addressing table of path indices.
+ * Paths grouped by first edge (in the order of enumeration) form an index built once on demand.
+ * Insertion methods (AddPath, AddStorage) are thread-safe, but should not be mixed with reading.
+ */
 template<class Graph>
 class PathStorage {
     friend class PathInfo<Graph> ;
     typedef typename Graph::EdgeId EdgeId;
-    typedef map<EdgeId, set<PathInfo<Graph> > > InnerIndex;
+    typedef typename std::vector<EdgeId>::const_iterator EdgeIterator;
 
     const Graph &g_;
-    InnerIndex inner_index_;
+    std::vector<EdgeId> edges_;
+    std::vector<size_t> offsets_;
+    std::vector<float> weights_;
+    //path index + 1, zero for empty slot
+    std::vector<size_t> table_;
+    //paths sorted by first edge and then lexicographically
+    mutable std::vector<size_t> order_;
+    mutable bool order_valid_;
+    mutable std::mutex lock_;
     static const size_t kLongEdgeForStats = 500;
 
-    void HiddenAddPath(const vector<EdgeId> &p, int w){
-        if (p.size() == 0 ) return;
-        for (typename set<PathInfo<Graph> >::iterator iter = inner_index_[p[0]].begin(); iter != inner_index_[p[0]].end(); ++iter) {
+    EdgeIterator PathBegin(size_t i) const {
+        return edges_.begin() + offsets_[i];
+    }
+
+    EdgeIterator PathEnd(size_t i) const {
+        return edges_.begin() + offsets_[i + 1];
+    }
+
+    static size_t PathHash(EdgeIterator begin, EdgeIterator end) {
+        size_t h = 0xcbf29ce484222325ull;
+        for (auto it = begin; it != end; ++it) {
+            h ^= it->hash();
+            h *= 0x100000001b3ull;
+            h ^= h >> 29;
+        }
+        return h;
+    }
 
-            if (iter->path == p) {
-                iter->increaseWeight(w);
+    void Rehash(size_t capacity) {
+        table_.assign(capacity, 0);
+        for (size_t i = 0; i < weights_.size(); ++i) {
+            size_t slot = PathHash(PathBegin(i), PathEnd(i)) & (capacity - 1);
+            while (table_[slot])
+                slot = (slot + 1) & (capacity - 1);
+            table_[slot] = i + 1;
+        }
+    }
+
+    //Adds the path or increases the weight of the existing one (if add_weight is set)
+    void HiddenAddPath(EdgeIterator begin, EdgeIterator end, float w, bool add_weight = true) {
+        if (begin == end)
+            return;
+        if (2 * (weights_.size() + 1) > table_.size())
+            Rehash(std::max<size_t>(16, 2 * table_.size()));
+
+        size_t slot = PathHash(begin, end) & (table_.size() - 1);
+        for (; table_[slot]; slot = (slot + 1) & (table_.size() - 1)) {
+            size_t i = table_[slot] - 1;
+            if (size_t(end - begin) == offsets_[i + 1] - offsets_[i] &&
+                std::equal(begin, end, PathBegin(i))) {
+                if (add_weight)
+                    weights_[i] += w;
                 return;
             }
         }
-        inner_index_[p[0]].insert(PathInfo<Graph>(p, w));
-        size_++;
+        table_[slot] = weights_.size() + 1;
+        edges_.insert(edges_.end(), begin, end);
+        offsets_.push_back(edges_.size());
+        weights_.push_back(w);
+        order_valid_ = false;
+    }
+
+    const std::vector<size_t>& Order() const {
+        std::lock_guard<std::mutex> guard(lock_);
+        if (!order_valid_) {
+            order_.resize(weights_.size());
+            std::iota(order_.begin(), order_.end(), 0);
+            std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+                return std::lexicographical_compare(PathBegin(a), PathEnd(a),
+                                                    PathBegin(b), PathEnd(b));
+            });
+            order_valid_ = true;
+        }
+        return order_;
+    }
+
+    std::vector<EdgeId> GetPath(size_t i) const {
+        return std::vector<EdgeId>(PathBegin(i), PathEnd(i));
     }
 
 public:
 
     PathStorage(const Graph &g)
             : g_(g),
-              inner_index_(),
-              size_(0) {
+              offsets_(1, 0),
+              order_valid_(true) {
     }
 
     PathStorage(const PathStorage & p)
             : g_(p.g_),
-              inner_index_(),
-              size_(0) {
-        for (auto iter = p.inner_index_.begin(); iter != p.inner_index_.end();
-                iter++) {
-            for (auto j_iter = iter->second.begin();
-                    j_iter != iter->second.end(); j_iter++) {
-                this->AddPath(j_iter->path, (int) j_iter->getWeight());
-            }
-        }
+              edges_(p.edges_),
+              offsets_(p.offsets_),
+              weights_(p.weights_),
+              table_(p.table_),
+              order_valid_(false) {
     }
 
     void ReplaceEdges(map<EdgeId, EdgeId> &old_to_new){
-        map<int, EdgeId> tmp_map;
-//        for (auto iter = g_.SmartEdgeBegin(); !iter.IsEnd(); ++iter ){
-//            tmp_map[g_.int_id(*iter)] = *iter;
-//        }
-        InnerIndex new_index;
-        for (auto iter = inner_index_.begin(); iter != inner_index_.end(); iter++) {
-            auto tmp = iter->second;
-            EdgeId new_first;
-            if (old_to_new.find(iter->first) == old_to_new.end())
-                new_first = iter->first;
-            else {
-                DEBUG("new first edge: "<< g_.int_id(old_to_new[iter->first]) << " with " << tmp.size() << " edges ");
-                new_first = old_to_new[iter->first];
+        //Paths coinciding after replacement are not merged, the first one (in enumeration order) is kept
+        PathStorage<Graph> replaced(g_);
+        std::vector<EdgeId> path;
+        for (size_t i : Order()) {
+            path.assign(PathBegin(i), PathEnd(i));
+            for (size_t k = 0; k < path.size(); k++) {
+                auto it = old_to_new.find(path[k]);
+                if (it != old_to_new.end())
+                    path[k] = it->second;
             }
-            set<PathInfo<Graph> > new_tmp;
-            for (auto j_iter = tmp.begin(); j_iter != tmp.end(); j_iter++) {
-                PathInfo<Graph> pi = *(j_iter);
-                for (size_t k = 0; k < pi.path.size(); k++)
-                    if (old_to_new.find(pi.path[k]) != old_to_new.end()) {
-//                        INFO(g_.int_id(old_to_new[pi.path[k]]));
-                        pi.path[k] = old_to_new[pi.path[k]];
-                    }
-                DEBUG(pi.str(g_));
-                new_tmp.insert(pi);
-
-            }
-            if (new_first != iter->first) {
-                TRACE("and mmew_tmp.size: "<< new_tmp.size());
-            }
-            if (new_index.find(new_first) == new_index.end()) {
-                new_index[new_first] = new_tmp;
-            } else {
-                for (auto j_iter = new_tmp.begin(); j_iter != new_tmp.end(); j_iter++) {
-                    new_index[new_first].insert(*j_iter);
-                }
-            }
-
+            replaced.HiddenAddPath(path.begin(), path.end(), weights_[i], false);
         }
-
-        inner_index_ = new_index;
+        Swap(replaced);
     }
 
     void AddPath(const vector<EdgeId> &p, int w, bool add_rc = false) {
-        HiddenAddPath(p, w);
+        std::lock_guard<std::mutex> guard(lock_);
+        HiddenAddPath(p.begin(), p.end(), (float) w);
         if (add_rc) {
             vector<EdgeId> rc_p(p.size());
             for (size_t i = 0; i < p.size(); i++)
                 rc_p[i] = g_.conjugate(p[p.size() - 1 - i]);
-            HiddenAddPath(rc_p, w);
+            HiddenAddPath(rc_p.begin(), rc_p.end(), (float) w);
         }
     }
 
+    /*
+     * Calls handler(path, weight) for every stored path.
+     * Paths are enumerated by first edge, paths with the same first edge are sorted lexicographically.
+     */
+    template<class Handler>
+    void ForEachPath(Handler handler) const {
+        for (size_t i : Order())
+            handler(GetPath(i), (size_t) weights_[i]);
+    }
+
     void DumpToFile(const string& filename) const{
         map <EdgeId, EdgeId> auxilary;
         DumpToFile(filename, auxilary);
@@ -170,17 +224,25 @@ public:
         ofstream filestr(filename);
         set<EdgeId> continued_edges;
 
-        for(auto iter = inner_index_.begin(); iter != inner_index_.end(); ++iter){
-            filestr<< iter->second.size() << endl;
+        const auto &order = Order();
+        for (size_t group = 0; group < order.size(); ) {
+            EdgeId first = *PathBegin(order[group]);
+            size_t group_end = group;
+            while (group_end < order.size() && *PathBegin(order[group_end]) == first)
+                ++group_end;
+
+            filestr << group_end - group << endl;
             int non1 = 0;
-            for (auto j_iter = iter->second.begin(); j_iter != iter->second.end(); ++j_iter) {
-                filestr << " Weight: " << j_iter->getWeight();
-                if (j_iter->getWeight() > stats_weight_cutoff)
+            for (; group < group_end; ++group) {
+                size_t i = order[group];
+                size_t weight = (size_t) weights_[i];
+                filestr << " Weight: " << weight;
+                if (weight > stats_weight_cutoff)
                     non1++;
 
-                filestr << " length: " << j_iter->path.size() << " ";
-                for (auto p_iter = j_iter->path.begin(); p_iter != j_iter->path.end(); ++p_iter) {
-                    if (p_iter != j_iter->path.end() - 1 && j_iter->getWeight() > stats_weight_cutoff) {
+                filestr << " length: " << PathEnd(i) - PathBegin(i) << " ";
+                for (auto p_iter = PathBegin(i); p_iter != PathEnd(i); ++p_iter) {
+                    if (p_iter != PathEnd(i) - 1 && weight > stats_weight_cutoff) {
                         continued_edges.insert(*p_iter);
                     }
 
@@ -190,7 +252,6 @@ public:
             }
             filestr << endl;
         }
-
         int noncontinued = 0;
         int long_gapped = 0;
         int continued = 0;
@@ -223,12 +284,10 @@ public:
         }
     }
 
-     void SaveAllPaths(vector<PathInfo<Graph>> &res) const {
-        for (auto iter = inner_index_.begin(); iter != inner_index_.end(); ++iter) {
-            for (auto j_iter = iter->second.begin(); j_iter != iter->second.end(); ++j_iter) {
-                res.push_back(*j_iter);
-            }
-        }
+    void SaveAllPaths(vector<PathInfo<Graph>> &res) const {
+        ForEachPath([&res](const vector<EdgeId> &path, size_t weight) {
+            res.push_back(PathInfo<Graph>(path, weight));
+        });
     }
 
     void LoadFromFile(const string s, bool force_exists = true) {
@@ -283,36 +342,34 @@ public:
         INFO("Loading finished.");
     }
 
-    void AddStorage(PathStorage<Graph> & to_add) {
+    void AddStorage(const PathStorage<Graph> &to_add) {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (size_t i = 0; i < to_add.weights_.size(); ++i)
+            HiddenAddPath(to_add.PathBegin(i), to_add.PathEnd(i), to_add.weights_[i]);
+    }
 
-        for(auto iter = to_add.inner_index_.begin(); iter != to_add.inner_index_.end(); iter++) {
-            for(auto j_iter = iter->second.begin(); j_iter != iter->second.end(); j_iter ++) {
-                this->AddPath(j_iter->path, (int) j_iter->getWeight());
-            }
-        }
+    void Swap(PathStorage<Graph> &other) {
+        VERIFY(&g_ == &other.g_);
+        edges_.swap(other.edges_);
+        offsets_.swap(other.offsets_);
+        weights_.swap(other.weights_);
+        table_.swap(other.table_);
+        order_valid_ = false;
+        other.order_valid_ = false;
     }
 
     void Clear() {
-        inner_index_.clear();
-        size_ = 0;
+        std::vector<EdgeId>().swap(edges_);
+        offsets_.assign(1, 0);
+        std::vector<float>().swap(weights_);
+        std::vector<size_t>().swap(table_);
+        std::vector<size_t>().swap(order_);
+        order_valid_ = true;
     }
 
     size_t size() const {
-        return size_;
-    }
-
-//    typename InnerIndex::iterator begin() const {
-//        return inner_index.begin();
-//    }
-//
-//    typename InnerIndex::iterator end() const {
-//        return inner_index.end();
-//    }
-//    typename InnerIndex::iterator operator*(){
-//        return this->first;
-//    }
-private:
-    size_t size_;
+        return weights_.size();
+    }
 };
 
 template<class Graph>
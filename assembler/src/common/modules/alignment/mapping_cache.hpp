@@ -0,0 +1,187 @@
+//***************************************************************************
+//* Copyright (c) 2015 Saint Petersburg State University
+//* Copyright (c) 2011-2014 Saint Petersburg Academic University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "assembly_graph/paths/mapping_path.hpp"
+#include "utils/logger/logger.hpp"
+#include "utils/verify.hpp"
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace debruijn_graph {
+
+/*
+ * Stores mapping paths of reads produced during the first pass over a library
+ * and replays them on subsequent passes instead of mapping the reads again.
+ * Mappings are kept per read stream in the order the reads are read, every path
+ * is encoded as varints: dense edge index, initial and mapped ranges (start, size).
+ * The cache is valid only while the graph is not modified and the same set of streams is used.
+ */
+template<class Graph>
+class MappingCache {
+    typedef typename Graph::EdgeId EdgeId;
+    typedef omnigraph::MappingPath<EdgeId> MappingPathT;
+
+    enum class State {
+        Empty, Recording, Ready, Replaying, Disabled
+    };
+
+    size_t max_bytes_;
+    State state_;
+    std::unordered_map<EdgeId, uint32_t> edge_index_;
+    std::vector<EdgeId> edges_;
+    std::vector<std::vector<uint8_t>> data_;
+    std::vector<size_t> read_pos_;
+    std::atomic<size_t> total_bytes_;
+    std::atomic<bool> overflow_;
+
+    static void Put(std::vector<uint8_t> &buf, uint64_t val) {
+        while (val >= 0x80) {
+            buf.push_back(uint8_t(val | 0x80));
+            val >>= 7;
+        }
+        buf.push_back(uint8_t(val));
+    }
+
+    static uint64_t Get(const std::vector<uint8_t> &buf, size_t &pos) {
+        uint64_t val = 0;
+        for (unsigned shift = 0; ; shift += 7) {
+            VERIFY(pos < buf.size());
+            uint8_t byte = buf[pos++];
+            val |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return val;
+        }
+    }
+
+    static void PutRange(std::vector<uint8_t> &buf, const Range &r) {
+        Put(buf, r.start_pos);
+        Put(buf, r.end_pos - r.start_pos);
+    }
+
+    static Range GetRange(const std::vector<uint8_t> &buf, size_t &pos) {
+        size_t start = Get(buf, pos);
+        return Range(start, start + Get(buf, pos));
+    }
+
+    void Clear() {
+        std::vector<std::vector<uint8_t>>().swap(data_);
+        std::vector<size_t>().swap(read_pos_);
+        std::vector<EdgeId>().swap(edges_);
+        edge_index_.clear();
+    }
+
+public:
+    /*
+     * @param max_bytes - caching is abandoned if encoded mappings exceed this size
+     */
+    MappingCache(const Graph &g, size_t max_bytes)
+            : max_bytes_(max_bytes), state_(State::Empty),
+              total_bytes_(0), overflow_(false) {
+        for (auto it = g.ConstEdgeBegin(); !it.IsEnd(); ++it) {
+            edge_index_[*it] = uint32_t(edges_.size());
+            edges_.push_back(*it);
+        }
+    }
+
+    /*
+     * Prepares the cache for the next pass over the library.
+     * @return true if mappings of this pass should be replayed from cache
+     */
+    bool StartPass(size_t stream_cnt) {
+        switch (state_) {
+            case State::Empty:
+                data_.resize(stream_cnt);
+                state_ = State::Recording;
+                return false;
+            case State::Ready:
+                VERIFY_MSG(data_.size() == stream_cnt, "Cached mappings were obtained for different streams");
+                read_pos_.assign(stream_cnt, 0);
+                state_ = State::Replaying;
+                return true;
+            case State::Disabled:
+                return false;
+            default:
+                VERIFY_MSG(false, "Mapping cache pass was not finished");
+        }
+        return false;
+    }
+
+    void FinishPass() {
+        if (state_ == State::Recording) {
+            if (overflow_) {
+                INFO("Mapping cache exceeded " << max_bytes_ << " bytes, mappings will be recomputed");
+                Clear();
+                state_ = State::Disabled;
+            } else {
+                INFO("Cached mappings take " << total_bytes_ << " bytes");
+                state_ = State::Ready;
+            }
+        } else if (state_ == State::Replaying) {
+            for (size_t i = 0; i < data_.size(); ++i)
+                VERIFY_MSG(read_pos_[i] == data_[i].size(), "Cached mappings were not fully replayed");
+            state_ = State::Ready;
+        }
+    }
+
+    bool recording() const {
+        return state_ == State::Recording;
+    }
+
+    bool replaying() const {
+        return state_ == State::Replaying;
+    }
+
+    /*
+     * Reads of each stream should be stored (and then loaded) by a single thread.
+     */
+    void Store(size_t stream, const MappingPathT &path) {
+        VERIFY(state_ == State::Recording);
+        if (overflow_)
+            return;
+        auto &buf = data_[stream];
+        size_t old_size = buf.size();
+        Put(buf, path.size());
+        for (size_t i = 0; i < path.size(); ++i) {
+            auto it = edge_index_.find(path.edge_at(i));
+            VERIFY(it != edge_index_.end());
+            Put(buf, it->second);
+            MappingRange mr = path.mapping_at(i);
+            PutRange(buf, mr.initial_range);
+            PutRange(buf, mr.mapped_range);
+        }
+        if (total_bytes_.fetch_add(buf.size() - old_size) + buf.size() - old_size > max_bytes_) {
+            overflow_ = true;
+            std::vector<uint8_t>().swap(buf);
+        }
+    }
+
+    MappingPathT Load(size_t stream) {
+        VERIFY(state_ == State::Replaying);
+        const auto &buf = data_[stream];
+        size_t &pos = read_pos_[stream];
+        MappingPathT path;
+        size_t size = Get(buf, pos);
+        for (size_t i = 0; i < size; ++i) {
+            size_t idx = Get(buf, pos);
+            VERIFY(idx < edges_.size());
+            Range initial = GetRange(buf, pos);
+            Range mapped = GetRange(buf, pos);
+            path.push_back(edges_[idx], MappingRange(initial, mapped));
+        }
+        return path;
+    }
+
+private:
+    DECL_LOGGER("MappingCache");
+};
+
+}
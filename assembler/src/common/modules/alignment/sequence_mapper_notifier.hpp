@@ -11,11 +11,14 @@
 #include "utils/memory_limit.hpp"
 #include "sequence_mapper.hpp"
 #include "short_read_mapper.hpp"
+#include "mapping_cache.hpp"
 #include "io/reads/paired_read.hpp"
 #include "io/reads/read_stream_vector.hpp"
 #include "pipeline/graph_pack.hpp"
 
 #include <vector>
+#include <atomic>
+#include <functional>
 #include <cstdlib>
 
 namespace debruijn_graph {
@@ -40,11 +43,24 @@ public:
 
 class SequenceMapperNotifier {
     static constexpr size_t BUFFER_SIZE = 200000;
+    static constexpr size_t SAMPLING_BUFFER_SIZE = 10000;
 public:
     typedef SequenceMapper<conj_graph_pack::graph_t> SequenceMapperT;
+    typedef MappingCache<conj_graph_pack::graph_t> MappingCacheT;
 
     SequenceMapperNotifier(const conj_graph_pack& gp)
-            : gp_(gp) { }
+            : gp_(gp), cache_(nullptr) { }
+
+    //Mappings of paired binary reads are recorded to (or replayed from) the cache
+    void UseMappingCache(MappingCacheT &cache) {
+        cache_ = &cache;
+    }
+
+    //Processing of the library is stopped as soon as the condition holds.
+    //The condition is checked after every buffer merge, smaller buffers are used then.
+    void StopWhen(std::function<bool()> condition) {
+        stop_condition_ = condition;
+    }
 
     void Subscribe(size_t lib_index, SequenceMapperListener* listener) {
         while ((int)lib_index >= (int)listeners_.size() - 1) {
@@ -60,18 +76,25 @@ public:
         if (threads_count == 0)
             threads_count = streams.size();
 
+        //Partially processed library should not be recorded to (or replayed from) the cache
+        VERIFY_MSG(!cache_ || !stop_condition_, "Mapping cache can not be used with stop condition");
+
         streams.reset();
+        if (cache_ && cache_->StartPass(streams.size()))
+            INFO("Using cached read mappings");
         NotifyStartProcessLibrary(lib_index, threads_count);
         size_t counter = 0, n = 15;
         size_t fmem = get_free_memory();
+        size_t buffer_size = stop_condition_ ? SAMPLING_BUFFER_SIZE : BUFFER_SIZE;
+        std::atomic<bool> stop(false);
 
         #pragma omp parallel for num_threads(threads_count) shared(counter)
         for (size_t i = 0; i < streams.size(); ++i) {
             size_t size = 0;
             ReadType r;
             auto& stream = streams[i];
-            while (!stream.eof()) {
-                if (size == BUFFER_SIZE || 
+            while (!stream.eof() && !stop) {
+                if (size == buffer_size || 
                     // Stop filling buffer if the amount of available is smaller
                     // than half of free memory.
                     (10 * get_free_memory() / 4 < fmem && size > 10000)) {
@@ -84,6 +107,8 @@ public:
                         }
                         size = 0;
                         NotifyMergeBuffer(lib_index, i);
+                        if (stop_condition_ && stop_condition_())
+                            stop = true;
                     }
                 }
                 stream >> r;
@@ -97,7 +122,13 @@ public:
         for (size_t i = 0; i < threads_count; ++i)
             NotifyMergeBuffer(lib_index, i);
 
-        INFO("Total " << counter << " reads processed");
+        if (stop) {
+            INFO("Processing stopped after " << counter << " reads");
+        } else {
+            INFO("Total " << counter << " reads processed");
+        }
+        if (cache_)
+            cache_->FinishPass();
         NotifyStopProcessLibrary(lib_index);
     }
 
@@ -120,6 +151,8 @@ private:
             listener->MergeBuffer(ithread);
     }
     const conj_graph_pack& gp_;
+    MappingCacheT *cache_;
+    std::function<bool()> stop_condition_;
 
     std::vector<std::vector<SequenceMapperListener*> > listeners_;  //first vector's size = count libs
 };
@@ -130,10 +163,18 @@ inline void SequenceMapperNotifier::NotifyProcessRead(const io::PairedReadSeq& r
                                                       size_t ilib,
                                                       size_t ithread) const {
 
-    const Sequence& read1 = r.first().sequence();
-    const Sequence& read2 = r.second().sequence();
-    MappingPath<EdgeId> path1 = mapper.MapSequence(read1);
-    MappingPath<EdgeId> path2 = mapper.MapSequence(read2);
+    MappingPath<EdgeId> path1, path2;
+    if (cache_ && cache_->replaying()) {
+        path1 = cache_->Load(ithread);
+        path2 = cache_->Load(ithread);
+    } else {
+        path1 = mapper.MapSequence(r.first().sequence());
+        path2 = mapper.MapSequence(r.second().sequence());
+        if (cache_ && cache_->recording()) {
+            cache_->Store(ithread, path1);
+            cache_->Store(ithread, path2);
+        }
+    }
     for (const auto& listener : listeners_[ilib]) {
         TRACE("Dist: " << r.second().size() << " - " << r.insert_size() << " = " << r.second().size() - r.insert_size());
         listener->ProcessPairedRead(ithread, r, path1, path2);
@@ -15,6 +15,10 @@
 #include "modules/alignment/sequence_mapper.hpp"
 
 #include "pipeline/config_struct.hpp"
+#include "utils/openmp_wrapper.h"
+
+#include <unordered_map>
+#include <algorithm>
 
 namespace debruijn_graph {
 
@@ -39,44 +43,49 @@ struct NuclCount {
     }
 };
 
-struct MismatchEdgeInfo {
-    NuclCount operator[](size_t i) const {
-        auto it = info_.find(i);
-        if (it == info_.end())
-            return NuclCount();
-        else
-            return it->second;
-    }
+/*
+ * Read-only view of the candidate positions of a single edge
+ * stored in the flat arrays of MismatchStatistics.
+ */
+class MismatchEdgeInfo {
+    const size_t *positions_;
+    const NuclCount *counts_;
+    size_t size_;
 
-    void operator+=(const MismatchEdgeInfo &other) {
-        for (auto it = other.info_.begin(); it != other.info_.end(); ++it) {
-            info_[it->first] += it->second;
-        }
+public:
+    MismatchEdgeInfo(const size_t *positions, const NuclCount *counts, size_t size)
+            : positions_(positions), counts_(counts), size_(size) {
     }
 
-    void IncIfContains(size_t position, size_t nucl) {
-        auto it = info_.find(position);
-        if (it != info_.end()) {
-            it->second[nucl]++;
-        }
+    NuclCount operator[](size_t i) const {
+        const size_t *it = std::lower_bound(positions_, positions_ + size_, i);
+        if (it == positions_ + size_ || *it != i)
+            return NuclCount();
+        else
+            return counts_[it - positions_];
     }
 
-    void AddPosition(size_t position) {
-        info_[position]; //in case map did not contain this key creates entry in the map with default value
+    size_t size() const {
+        return size_;
     }
-
-public:
-    map<size_t, NuclCount> info_;
 };
 
+/*
+ * Candidate positions of all edges are kept in a single sorted array (grouped by edge),
+ * nucleotide counts live in the parallel array of the same size.
+ */
 template<typename EdgeId>
 class MismatchStatistics {
 private:
-    typedef typename map<EdgeId, MismatchEdgeInfo>::const_iterator const_iterator;
-    map<EdgeId, MismatchEdgeInfo> statistics_;
+    typedef std::pair<size_t, size_t> Bounds;
+
+    std::vector<size_t> positions_;
+    std::vector<NuclCount> counts_;
+    std::unordered_map<EdgeId, Bounds> edges_;
 
     template<class graph_pack>
     void CollectPotensialMismatches(const graph_pack &gp) {
+        std::vector<std::pair<EdgeId, size_t>> candidates;
         auto &kmer_mapper = gp.kmer_mapper;
         for (auto it = kmer_mapper.begin(); it != kmer_mapper.end(); ++it) {
             // Kmer mapper iterator dereferences to pair (KMer, KMer), not to the reference!
@@ -101,39 +110,32 @@ private:
                 for (size_t i = 0; i < from.size(); i++) {
                     if (from[i] != to[i] && gp.index.contains(to)) {
                         pair<EdgeId, size_t> position = gp.index.get(to);
-                        statistics_[position.first].AddPosition(position.second + i);
+                        candidates.push_back(std::make_pair(position.first, position.second + i));
                     }
                 }
             }
         }
-    }
-
-    void operator+=(const MismatchStatistics<EdgeId> &other) {
-        for (auto it = other.statistics_.begin(); it != other.statistics_.end(); ++it) {
-            statistics_[it->first] += it->second;
-        }
-    }
-
-public:
-    template<class graph_pack>
-    MismatchStatistics(const graph_pack &gp) {
-        CollectPotensialMismatches(gp);
-    }
 
-    const_iterator begin() const {
-        return statistics_.begin();
-    }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 
-    const_iterator end() const {
-        return statistics_.end();
+        positions_.reserve(candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (i == 0 || candidates[i].first != candidates[i - 1].first)
+                edges_[candidates[i].first] = Bounds(i, i);
+            edges_[candidates[i].first].second = i + 1;
+            positions_.push_back(candidates[i].second);
+        }
+        counts_.resize(positions_.size());
     }
 
-    const_iterator find(const EdgeId &edge) const {
-        return statistics_.find(edge);
+    MismatchEdgeInfo info(const Bounds &bounds) const {
+        return MismatchEdgeInfo(positions_.data() + bounds.first, counts_.data() + bounds.first,
+                                bounds.second - bounds.first);
     }
 
     template<class graph_pack, class read_type>
-    void Count(io::ReadStream<read_type> &stream, const graph_pack &gp) {
+    void Count(io::ReadStream<read_type> &stream, const graph_pack &gp, std::vector<NuclCount> &counts) const {
         stream.reset();
         DEBUG("count started");
         auto sm = MapperInstance(gp);
@@ -157,37 +159,63 @@ public:
                 }
                 if (cnt <= gp.g.k() / 3) {
                     TRACE("statistics changing");
-                    auto it = statistics_.find(path[0].first);
-                    if (it == statistics_.end()) {
+                    auto it = edges_.find(path[0].first);
+                    if (it == edges_.end()) {
                         //                            if (gp.g.length(path[0].first) < 4000)
                         //                                WARN ("id "<< gp.g.length(path[0].first)<<"  " << len);
                         continue;
                     }
-                    for (size_t i = 0; i < len; i++) {
-                        size_t nucl_code = s_read[initial_range.start_pos + i];
-                        it->second.IncIfContains(mapped_range.start_pos + i, nucl_code);
+                    //positions covered by the read form a contiguous range, so walk sorted candidates once
+                    auto pos_begin = positions_.begin() + it->second.first;
+                    auto pos_end = positions_.begin() + it->second.second;
+                    for (auto pos_it = std::lower_bound(pos_begin, pos_end, mapped_range.start_pos);
+                         pos_it != pos_end && *pos_it < mapped_range.start_pos + len; ++pos_it) {
+                        size_t nucl_code = s_read[initial_range.start_pos + (*pos_it - mapped_range.start_pos)];
+                        counts[pos_it - positions_.begin()][nucl_code]++;
                     }
                 }
             }
         }
     }
 
+public:
+    template<class graph_pack>
+    MismatchStatistics(const graph_pack &gp) {
+        CollectPotensialMismatches(gp);
+    }
+
+    bool contains(const EdgeId &edge) const {
+        return edges_.count(edge) > 0;
+    }
+
+    MismatchEdgeInfo info(const EdgeId &edge) const {
+        auto it = edges_.find(edge);
+        VERIFY(it != edges_.end());
+        return info(it->second);
+    }
+
+    template<class graph_pack, class read_type>
+    void Count(io::ReadStream<read_type> &stream, const graph_pack &gp) {
+        Count(stream, gp, counts_);
+    }
+
     template<class graph_pack, class read_type>
     void ParallelCount(io::ReadStreamList<read_type> &streams, const graph_pack &gp) {
         size_t nthreads = streams.size();
-        std::vector<MismatchStatistics<EdgeId> *> statistics(nthreads);
-#pragma omp parallel for num_threads(nthreads) shared(streams, statistics)
+        std::vector<std::vector<NuclCount>> thread_counts(nthreads);
+#pragma omp parallel for num_threads(nthreads) shared(streams, thread_counts)
         for (size_t i = 0; i < nthreads; ++i) {
-            statistics[i] = new MismatchStatistics<EdgeId>(*this);
+            thread_counts[i].resize(counts_.size());
             DEBUG("statistics created thread " << i);
-            statistics[i]->Count(streams[i], gp);
+            Count(streams[i], gp, thread_counts[i]);
             DEBUG("count finished thread " << i);
         }
 
         INFO("Finished collecting potential mismatches positions");
-        for (size_t i = 0; i < statistics.size(); i++) {
-            *this += *statistics[i];
-            delete statistics[i];
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+        for (size_t j = 0; j < counts_.size(); ++j) {
+            for (size_t i = 0; i < nthreads; ++i)
+                counts_[j] += thread_counts[i][j];
         }
     }
 };
@@ -256,15 +284,6 @@ private:
         return to_correct;
     }
 
-    size_t CorrectEdge(EdgeId edge, const mismatches::MismatchEdgeInfo &statistics) {
-        vector<pair<size_t, char>> to_correct = FindMismatches(edge, statistics);
-        EdgeId new_edge = CorrectNucls(edge, to_correct);
-        if (new_edge == EdgeId(0))
-            new_edge = edge;
-
-        return to_correct.size();
-    }
-
     size_t CorrectAllEdges(const mismatches::MismatchStatistics<typename Graph::EdgeId> &statistics) {
         size_t res = 0;
         set<EdgeId> conjugate_fix;
@@ -273,13 +292,23 @@ private:
                 conjugate_fix.insert(*it);
             }
         }
-        for (auto it = conjugate_fix.begin(); it != conjugate_fix.end(); ++it) {
-            DEBUG("processing edge" << gp_.g.int_id(*it));
+        std::vector<EdgeId> to_process;
+        for (EdgeId e : conjugate_fix) {
+            if (statistics.contains(e) && !gp_.g.RelatedVertices(gp_.g.EdgeStart(e), gp_.g.EdgeEnd(e)))
+                to_process.push_back(e);
+        }
 
-            if (statistics.find(*it) != statistics.end()) {
-                if (!gp_.g.RelatedVertices(gp_.g.EdgeStart(*it), gp_.g.EdgeEnd(*it)))
-                    res += CorrectEdge(*it, statistics.find(*it)->second);
-            }
+        //search is read-only, while corrections modify the graph and are applied sequentially
+        std::vector<vector<pair<size_t, char>>> to_correct(to_process.size());
+#pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < to_process.size(); ++i) {
+            to_correct[i] = FindMismatches(to_process[i], statistics.info(to_process[i]));
+        }
+
+        for (size_t i = 0; i < to_process.size(); ++i) {
+            DEBUG("processing edge" << gp_.g.int_id(to_process[i]));
+            CorrectNucls(to_process[i], to_correct[i]);
+            res += to_correct[i].size();
         }
         INFO("All edges processed");
         return res;
@@ -17,6 +17,9 @@
 
 #include "assembly_graph/paths/bidirectional_path.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace path_extend {
 
 using namespace debruijn_graph;
@@ -49,64 +52,193 @@ inline bool InBuble(EdgeId e, const Graph& g) {
 
 // Handles all paths in PathContainer.
 // For each edge output all paths  that _traverse_ this path. If path contains multiple instances - count them. Position of the edge is not reported.
+/*
+ * Paths covering a single edge with multiplicity, ordered by path id.
+ * Most edges are covered by a few paths only, so entries are kept in a flat sorted vector
+ * and compared by ids stored alongside the pointers, without dereferencing the paths.
+ */
+class EdgePaths {
+    struct Entry {
+        size_t id;
+        BidirectionalPath *path;
+    };
+
+    typedef std::vector<Entry> StorageT;
+
+    StorageT entries_;
+
+    StorageT::iterator LowerBound(size_t id) {
+        return std::lower_bound(entries_.begin(), entries_.end(), id,
+                                [](const Entry &entry, size_t val) { return entry.id < val; });
+    }
+
+    StorageT::const_iterator LowerBound(size_t id) const {
+        return std::lower_bound(entries_.begin(), entries_.end(), id,
+                                [](const Entry &entry, size_t val) { return entry.id < val; });
+    }
+
+public:
+    class const_iterator {
+        StorageT::const_iterator it_;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef BidirectionalPath *value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef BidirectionalPath *const *pointer;
+        typedef BidirectionalPath *const &reference;
+
+        explicit const_iterator(StorageT::const_iterator it) : it_(it) {}
+
+        reference operator*() const {
+            return it_->path;
+        }
+
+        const_iterator &operator++() {
+            ++it_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator res = *this;
+            ++it_;
+            return res;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return it_ == other.it_;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return it_ != other.it_;
+        }
+    };
+
+    const_iterator begin() const {
+        return const_iterator(entries_.begin());
+    }
+
+    const_iterator end() const {
+        return const_iterator(entries_.end());
+    }
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    bool empty() const {
+        return entries_.empty();
+    }
+
+    size_t count(const BidirectionalPath *path) const {
+        size_t id = path->GetId();
+        size_t res = 0;
+        for (auto it = LowerBound(id); it != entries_.end() && it->id == id; ++it)
+            ++res;
+        return res;
+    }
+
+    void Insert(BidirectionalPath *path) {
+        size_t id = path->GetId();
+        auto it = LowerBound(id);
+        while (it != entries_.end() && it->id == id)
+            ++it;
+        entries_.insert(it, Entry{id, path});
+    }
+
+    //Removes a single occurrence of the path, returns false if there is none
+    bool Erase(const BidirectionalPath *path) {
+        auto it = LowerBound(path->GetId());
+        if (it == entries_.end() || it->id != path->GetId())
+            return false;
+        entries_.erase(it);
+        return true;
+    }
+};
+
+/*
+ * Paths covering each edge of the graph.
+ * Path sets are stored in an array of slots assigned to all edges of the graph on construction
+ * and to the new edges once they get covered. Slots are looked up by edge int ids.
+ */
 class GraphCoverageMap: public PathListener {
 
 public:
-    typedef BidirectionalPathMultiset MapDataT;
+    typedef EdgePaths MapDataT;
 
 
 private:
+    static const uint32_t kNoIndex = uint32_t(-1);
+
     const Graph& g_;
 
-    std::unordered_map <EdgeId, MapDataT * > edge_coverage_;
+    //slot of an edge by its int id, kNoIndex for edges without a slot
+    std::vector<uint32_t> edge_index_;
 
-    MapDataT * empty_;
+    std::vector<MapDataT> edge_coverage_;
+
+    size_t covered_edges_;
+
+    MapDataT empty_;
+
+    uint32_t Index(EdgeId e) const {
+        size_t id = e.int_id();
+        if (id >= edge_index_.size())
+            return kNoIndex;
+        return edge_index_[id];
+    }
+
+    void IndexEdges() {
+        size_t edge_count = 0, max_id = 0;
+        for (auto e = g_.ConstEdgeBegin(); !e.IsEnd(); ++e) {
+            ++edge_count;
+            max_id = std::max(max_id, (*e).int_id());
+        }
+        edge_index_.assign(edge_count ? max_id + 1 : 0, uint32_t(kNoIndex));
+        edge_coverage_.reserve(edge_count);
+        for (auto e = g_.ConstEdgeBegin(); !e.IsEnd(); ++e) {
+            edge_index_[(*e).int_id()] = uint32_t(edge_coverage_.size());
+            edge_coverage_.emplace_back();
+        }
+    }
 
     virtual void EdgeAdded(EdgeId e, BidirectionalPath * path, Gap /*gap*/) {
-        auto iter = edge_coverage_.find(e);
-        if (iter == edge_coverage_.end()) {
-            edge_coverage_.insert(std::make_pair(e, new MapDataT()));
+        size_t id = e.int_id();
+        if (id >= edge_index_.size())
+            edge_index_.resize(id + 1, uint32_t(kNoIndex));
+        if (edge_index_[id] == kNoIndex) {
+            edge_index_[id] = uint32_t(edge_coverage_.size());
+            edge_coverage_.emplace_back();
         }
-        edge_coverage_[e]->insert(path);
+        MapDataT &paths = edge_coverage_[edge_index_[id]];
+        if (paths.empty())
+            ++covered_edges_;
+        paths.Insert(path);
     }
 
     virtual void EdgeRemoved(EdgeId e, BidirectionalPath * path) {
-        auto iter = edge_coverage_.find(e);
-        if (iter != edge_coverage_.end()) {
-            if (iter->second->count(path) == 0) {
+        uint32_t idx = Index(e);
+        if (idx != kNoIndex) {
+            MapDataT &paths = edge_coverage_[idx];
+            if (!paths.Erase(path)) {
                 DEBUG("Error erasing path from coverage map");
-            } else {
-                auto entry = iter->second->find(path);
-                iter->second->erase(entry);
+            } else if (paths.empty()) {
+                --covered_edges_;
             }
         }
     }
 
-    size_t EdgeCount() const {
-        size_t result = 0;
-        for (auto e = g_.ConstEdgeBegin(); !e.IsEnd(); ++e) {
-            ++result;
-        }
-        return result;
-    }
-
 public:
-    GraphCoverageMap(const Graph& g) : g_(g), edge_coverage_() {
-        empty_ = new MapDataT();
-        edge_coverage_.reserve(EdgeCount());
+    GraphCoverageMap(const Graph& g) : g_(g), covered_edges_(0) {
+        IndexEdges();
     }
 
-    GraphCoverageMap(const Graph& g, const PathContainer& paths, bool subscribe = false) : g_(g), edge_coverage_() {
-        empty_ = new MapDataT();
-        edge_coverage_.reserve(EdgeCount());
+    GraphCoverageMap(const Graph& g, const PathContainer& paths, bool subscribe = false) : g_(g), covered_edges_(0) {
+        IndexEdges();
         AddPaths(paths, subscribe);
     }
 
     virtual ~GraphCoverageMap() {
-        delete empty_;
-        for (auto iter = edge_coverage_.begin(); iter != edge_coverage_.end(); ++iter) {
-            delete iter->second;
-        }
     }
 
     void AddPaths(const PathContainer& paths, bool subscribe = false) {
@@ -151,12 +283,12 @@ public:
         EdgeRemoved(e, path);
     }
 
-    MapDataT * GetEdgePaths(EdgeId e) const {
-        auto iter = edge_coverage_.find(e);
-        if (iter != edge_coverage_.end()) {
-            return iter->second;
+    const MapDataT * GetEdgePaths(EdgeId e) const {
+        uint32_t idx = Index(e);
+        if (idx != kNoIndex) {
+            return &edge_coverage_[idx];
         }
-        return empty_;
+        return &empty_;
     }
 
     int GetCoverage(EdgeId e) const {
@@ -181,14 +313,6 @@ public:
         return BidirectionalPathSet(mapData->begin(), mapData->end());
     }
 
-    std::unordered_map <EdgeId, MapDataT * >::const_iterator begin() const {
-        return edge_coverage_.begin();
-    }
-
-    std::unordered_map <EdgeId, MapDataT * >::const_iterator end() const {
-        return edge_coverage_.end();
-    }
-
     // DEBUG output
     void PrintUncovered() const {
         DEBUG("Uncovered edges");
@@ -216,8 +340,9 @@ public:
         }
     }
 
+    //Number of edges covered by at least one path
     size_t size() const {
-        return edge_coverage_.size();
+        return covered_edges_;
     }
 
     const Graph& graph() const {
@@ -225,7 +350,7 @@ public:
     }
 
 private:
-    GraphCoverageMap(const GraphCoverageMap& t) : g_(t.g_), empty_(t.empty_) {}
+    GraphCoverageMap(const GraphCoverageMap& t) : g_(t.g_), covered_edges_(0) {}
 };
 
 inline bool GetLoopAndExit(const Graph& g, EdgeId e, pair<EdgeId, EdgeId>& result) {
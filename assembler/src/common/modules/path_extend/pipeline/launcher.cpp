@@ -289,19 +289,16 @@ Extenders PathExtendLauncher::ConstructMPExtenders(const ExtendersGenerator &gen
 }
 
 void PathExtendLauncher::FillPathContainer(size_t lib_index, size_t size_threshold) {
-    std::vector<PathInfo<Graph>> paths;
-    gp_.single_long_reads[lib_index].SaveAllPaths(paths);
-    for (const auto &path: paths) {
-        const auto &edges = path.getPath();
+    gp_.single_long_reads[lib_index].ForEachPath([&](const std::vector<EdgeId> &edges, size_t weight) {
         if (edges.size() <= size_threshold)
-            continue;
+            return;
 
         BidirectionalPath *new_path = new BidirectionalPath(gp_.g, edges);
         BidirectionalPath *conj_path = new BidirectionalPath(new_path->Conjugate());
-        new_path->SetWeight((float) path.getWeight());
-        conj_path->SetWeight((float) path.getWeight());
+        new_path->SetWeight((float) weight);
+        conj_path->SetWeight((float) weight);
         unique_data_.long_reads_paths_[lib_index]->AddPair(new_path, conj_path);
-    }
+    });
     DEBUG("Long reads paths " << unique_data_.long_reads_paths_[lib_index]->size());
     unique_data_.long_reads_cov_map_[lib_index]->AddPaths(*unique_data_.long_reads_paths_[lib_index]);
 }
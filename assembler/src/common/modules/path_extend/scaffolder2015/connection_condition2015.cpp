@@ -221,13 +221,17 @@ AssemblyGraphConnectionCondition::AssemblyGraphConnectionCondition(const debruij
 
 map <debruijn_graph::EdgeId, double> AssemblyGraphConnectionCondition::ConnectedWith(debruijn_graph::EdgeId e) const {
     VERIFY_MSG(interesting_edge_set_.find(e)!= interesting_edge_set_.end(), " edge "<< e.int_id() << " not applicable for connection condition");
-    if (stored_distances_.find(e) != stored_distances_.end()) {
-        return stored_distances_[e];
+    {
+        std::lock_guard<std::mutex> guard(stored_distances_lock_);
+        auto it = stored_distances_.find(e);
+        if (it != stored_distances_.end()) {
+            return it->second;
+        }
     }
-    stored_distances_.insert(make_pair(e, map<debruijn_graph::EdgeId, double>()));
+    map<debruijn_graph::EdgeId, double> result;
     for (auto connected: g_.OutgoingEdges(g_.EdgeEnd(e))) {
         if (interesting_edge_set_.find(connected) != interesting_edge_set_.end()) {
-            stored_distances_[e].insert(make_pair(connected, 1));
+            result.insert(make_pair(connected, 1));
         }
     }
     DijkstraHelper<debruijn_graph::Graph>::BoundedDijkstra dijkstra(
@@ -236,11 +240,13 @@ map <debruijn_graph::EdgeId, double> AssemblyGraphConnectionCondition::Connected
     for (auto v: dijkstra.ReachedVertices()) {
         for (auto connected: g_.OutgoingEdges(v)) {
             if (interesting_edge_set_.find(connected) != interesting_edge_set_.end() && dijkstra.GetDistance(v) < max_connection_length_) {
-                stored_distances_[e].insert(make_pair(connected, 1));
+                result.insert(make_pair(connected, 1));
             }
         }
     }
-    return stored_distances_[e];
+    std::lock_guard<std::mutex> guard(stored_distances_lock_);
+    stored_distances_.insert(make_pair(e, result));
+    return result;
 }
 void AssemblyGraphConnectionCondition::AddInterestingEdges(func::TypedPredicate<typename Graph::EdgeId> edge_condition) {
     for (auto e_iter = g_.ConstEdgeBegin(); !e_iter.IsEnd(); ++e_iter) {
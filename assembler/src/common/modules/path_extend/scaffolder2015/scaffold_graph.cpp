@@ -7,49 +7,79 @@ namespace scaffold_graph {
 std::atomic<ScaffoldGraph::ScaffoldEdgeIdT> ScaffoldGraph::ScaffoldEdge::scaffold_edge_id_{0};
 
 
+size_t ScaffoldGraph::VertexIndex(ScaffoldGraph::ScaffoldVertex v) {
+    auto it = vertex_index_.find(v);
+    if (it != vertex_index_.end())
+        return it->second;
+    size_t idx = outgoing_edges_.size();
+    vertex_index_.emplace(v, idx);
+    outgoing_edges_.emplace_back();
+    incoming_edges_.emplace_back();
+    return idx;
+}
+
+const ScaffoldGraph::AdjacencyList &ScaffoldGraph::Outgoing(ScaffoldGraph::ScaffoldVertex v) const {
+    static const AdjacencyList empty;
+    auto it = vertex_index_.find(v);
+    return it == vertex_index_.end() ? empty : outgoing_edges_[it->second];
+}
+
+const ScaffoldGraph::AdjacencyList &ScaffoldGraph::Incoming(ScaffoldGraph::ScaffoldVertex v) const {
+    static const AdjacencyList empty;
+    auto it = vertex_index_.find(v);
+    return it == vertex_index_.end() ? empty : incoming_edges_[it->second];
+}
+
 void ScaffoldGraph::AddEdgeSimple(const ScaffoldGraph::ScaffoldEdge &e) {
-    edges_.emplace(e.getId(), e);
-    outgoing_edges_.emplace(e.getStart(), e.getId());
-    incoming_edges_.emplace(e.getEnd(), e.getId());
+    size_t pos = edges_.size();
+    edges_.push_back(e);
+    outgoing_edges_[VertexIndex(e.getStart())].push_back(pos);
+    incoming_edges_[VertexIndex(e.getEnd())].push_back(pos);
 }
 
-void ScaffoldGraph::DeleteOutgoing(const ScaffoldGraph::ScaffoldEdge &e) {
-    auto e_range = outgoing_edges_.equal_range(e.getStart());
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        if (edges_.at(edge_id->second) == e) {
-            outgoing_edges_.erase(edge_id);
+size_t ScaffoldGraph::FindEdge(const ScaffoldGraph::ScaffoldEdge &e) const {
+    for (size_t pos : Outgoing(e.getStart())) {
+        if (edges_[pos] == e) {
+            return pos;
         }
     }
+    return -1ul;
 }
 
-void ScaffoldGraph::DeleteIncoming(const ScaffoldGraph::ScaffoldEdge &e) {
-    auto e_range = incoming_edges_.equal_range(e.getEnd());
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        if (edges_.at(edge_id->second) == e) {
-            incoming_edges_.erase(edge_id);
-        }
-    }
+static void ReplaceInList(ScaffoldGraph::AdjacencyList &list, size_t from, size_t to) {
+    auto it = std::find(list.begin(), list.end(), from);
+    VERIFY(it != list.end());
+    if (to == -1ul)
+        list.erase(it);
+    else
+        *it = to;
 }
 
-void ScaffoldGraph::DeleteAllOutgoingEdgesSimple(ScaffoldGraph::ScaffoldVertex v) {
-    auto e_range = outgoing_edges_.equal_range(v);
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        DeleteIncoming(edges_.at(edge_id->second));
+void ScaffoldGraph::DeleteEdge(size_t pos) {
+    const ScaffoldEdge &e = edges_[pos];
+    ReplaceInList(outgoing_edges_[vertex_index_.at(e.getStart())], pos, -1ul);
+    ReplaceInList(incoming_edges_[vertex_index_.at(e.getEnd())], pos, -1ul);
+
+    size_t last = edges_.size() - 1;
+    if (pos != last) {
+        const ScaffoldEdge &moved = edges_[last];
+        ReplaceInList(outgoing_edges_[vertex_index_.at(moved.getStart())], last, pos);
+        ReplaceInList(incoming_edges_[vertex_index_.at(moved.getEnd())], last, pos);
+        edges_[pos] = moved;
     }
-    outgoing_edges_.erase(v);
+    edges_.pop_back();
 }
 
-void ScaffoldGraph::DeleteEdgeFromStorage(const ScaffoldGraph::ScaffoldEdge &e) {
-    VERIFY(!Exists(e));
-    edges_.erase(e.getId());
+void ScaffoldGraph::DeleteAllOutgoingEdgesSimple(ScaffoldGraph::ScaffoldVertex v) {
+    while (!Outgoing(v).empty()) {
+        DeleteEdge(Outgoing(v).back());
+    }
 }
 
 void ScaffoldGraph::DeleteAllIncomingEdgesSimple(ScaffoldGraph::ScaffoldVertex v) {
-    auto e_range = incoming_edges_.equal_range(v);
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        DeleteOutgoing(edges_.at(edge_id->second));
+    while (!Incoming(v).empty()) {
+        DeleteEdge(Incoming(v).back());
     }
-    incoming_edges_.erase(v);
 }
 
 bool ScaffoldGraph::Exists(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
@@ -57,13 +87,7 @@ bool ScaffoldGraph::Exists(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) co
 }
 
 bool ScaffoldGraph::Exists(const ScaffoldGraph::ScaffoldEdge &e) const {
-    auto e_range = outgoing_edges_.equal_range(e.getStart());
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        if (edges_.at(edge_id->second) == e) {
-            return true;
-        }
-    }
-    return false;
+    return FindEdge(e) != -1ul;
 }
 
 ScaffoldGraph::ScaffoldVertex ScaffoldGraph::conjugate(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
@@ -109,21 +133,21 @@ void ScaffoldGraph::Print(ostream &os) const {
         os << "Vertex " << int_id(v) << " ~ " << int_id(conjugate(v))
             << ": len = " << assembly_graph_.length(v) << ", cov = " << assembly_graph_.coverage(v) << endl;
     }
-    for (auto e_iter = edges_.begin(); e_iter != edges_.end(); ++e_iter) {
-        os << "Edge " << e_iter->second.getId() <<
-            ": " << int_id(e_iter->second.getStart()) << " -> " << int_id(e_iter->second.getEnd()) <<
-            ", lib index = " << e_iter->second.getColor() << ", weight " << e_iter->second.getWeight() << endl;
+    for (const auto &e : edges_) {
+        os << "Edge " << e.getId() <<
+            ": " << int_id(e.getStart()) << " -> " << int_id(e.getEnd()) <<
+            ", lib index = " << e.getColor() << ", weight " << e.getWeight() << endl;
     }
 }
 
 ScaffoldGraph::ScaffoldEdge ScaffoldGraph::UniqueIncoming(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
     VERIFY(HasUniqueIncoming(assembly_graph_edge));
-    return edges_.at(incoming_edges_.find(assembly_graph_edge)->second);
+    return edges_[Incoming(assembly_graph_edge).front()];
 }
 
 ScaffoldGraph::ScaffoldEdge ScaffoldGraph::UniqueOutgoing(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
     VERIFY(HasUniqueOutgoing(assembly_graph_edge));
-    return edges_.at(outgoing_edges_.find(assembly_graph_edge)->second);
+    return edges_[Outgoing(assembly_graph_edge).front()];
 }
 
 bool ScaffoldGraph::HasUniqueIncoming(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
@@ -135,27 +159,25 @@ bool ScaffoldGraph::HasUniqueOutgoing(ScaffoldGraph::ScaffoldVertex assembly_gra
 }
 
 size_t ScaffoldGraph::IncomingEdgeCount(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
-    return incoming_edges_.count(assembly_graph_edge);
+    return Incoming(assembly_graph_edge).size();
 }
 
 size_t ScaffoldGraph::OutgoingEdgeCount(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
-    return outgoing_edges_.count(assembly_graph_edge);
+    return Outgoing(assembly_graph_edge).size();
 }
 
 vector<ScaffoldGraph::ScaffoldEdge> ScaffoldGraph::IncomingEdges(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
     vector<ScaffoldEdge> result;
-    auto e_range = incoming_edges_.equal_range(assembly_graph_edge);
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        result.push_back(edges_.at(edge_id->second));
+    for (size_t pos : Incoming(assembly_graph_edge)) {
+        result.push_back(edges_[pos]);
     }
     return result;
 }
 
 vector<ScaffoldGraph::ScaffoldEdge> ScaffoldGraph::OutgoingEdges(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
     vector<ScaffoldEdge> result;
-    auto e_range = outgoing_edges_.equal_range(assembly_graph_edge);
-    for (auto edge_id = e_range.first; edge_id != e_range.second; ++edge_id) {
-        result.push_back(edges_.at(edge_id->second));
+    for (size_t pos : Outgoing(assembly_graph_edge)) {
+        result.push_back(edges_[pos]);
     }
     return result;
 }
@@ -213,7 +235,7 @@ adt::iterator_range<ScaffoldGraph::ConstScaffoldEdgeIterator> ScaffoldGraph::edg
 }
 
 bool ScaffoldGraph::IsVertexIsolated(ScaffoldGraph::ScaffoldVertex assembly_graph_edge) const {
-    bool result = incoming_edges_.count(assembly_graph_edge) == 0 && outgoing_edges_.count(assembly_graph_edge) == 0;
+    bool result = Incoming(assembly_graph_edge).empty() && Outgoing(assembly_graph_edge).empty();
     return result;
 }
 
@@ -226,10 +248,8 @@ bool ScaffoldGraph::RemoveVertex(ScaffoldGraph::ScaffoldVertex assembly_graph_ed
         DeleteAllOutgoingEdgesSimple(conjugate(assembly_graph_edge));
         DeleteAllIncomingEdgesSimple(conjugate(assembly_graph_edge));
 
-        VERIFY(incoming_edges_.count(assembly_graph_edge) == 0);
-        VERIFY(outgoing_edges_.count(assembly_graph_edge) == 0);
-        VERIFY(incoming_edges_.count(conjugate(assembly_graph_edge)) == 0);
-        VERIFY(outgoing_edges_.count(conjugate(assembly_graph_edge)) == 0);
+        VERIFY(IsVertexIsolated(assembly_graph_edge));
+        VERIFY(IsVertexIsolated(conjugate(assembly_graph_edge)));
 
         vertices_.erase(assembly_graph_edge);
         vertices_.erase(conjugate(assembly_graph_edge));
@@ -240,11 +260,9 @@ bool ScaffoldGraph::RemoveVertex(ScaffoldGraph::ScaffoldVertex assembly_graph_ed
 }
 
 bool ScaffoldGraph::RemoveEdge(const ScaffoldGraph::ScaffoldEdge &e) {
-    if (Exists(e)) {
-        DeleteOutgoing(e);
-        DeleteIncoming(e);
-        DeleteEdgeFromStorage(e);
-
+    size_t pos = FindEdge(e);
+    if (pos != -1ul) {
+        DeleteEdge(pos);
         return true;
     }
     return false;
@@ -85,10 +85,12 @@ public:
 
     //All vertices are stored in set
     typedef std::set<ScaffoldVertex> VertexStorage;
-    //Edges are stored in map: Id -> Edge Information
-    typedef std::unordered_map<ScaffoldEdgeIdT, ScaffoldEdge> EdgeStorage;
-    //Adjacency list contains vertrx and edge id (instead of whole edge information)
-    typedef std::unordered_multimap<ScaffoldVertex, ScaffoldEdgeIdT> AdjacencyStorage;
+    //Edges are stored contiguously, removal moves the last edge to the freed position
+    typedef std::vector<ScaffoldEdge> EdgeStorage;
+    //Adjacency list contains edge positions in edge storage (instead of whole edge information)
+    typedef std::vector<size_t> AdjacencyList;
+    //Adjacency lists are indexed by dense vertex index
+    typedef std::vector<AdjacencyList> AdjacencyStorage;
 
     struct ConstScaffoldEdgeIterator: public boost::iterator_facade<ConstScaffoldEdgeIterator,
                                                                     const ScaffoldEdge,
@@ -112,7 +114,7 @@ public:
         }
 
         const ScaffoldEdge& dereference() const {
-            return iter_->second;
+            return *iter_;
         }
     };
 
@@ -124,25 +126,32 @@ private:
 
     const debruijn_graph::Graph &assembly_graph_;
 
+    //Indices are not reused after vertex removal
+    std::unordered_map<ScaffoldVertex, size_t> vertex_index_;
+
     AdjacencyStorage outgoing_edges_;
 
     AdjacencyStorage incoming_edges_;
 
-    void AddEdgeSimple(const ScaffoldEdge &e);
+    //Index of vertex, assigned on first request
+    size_t VertexIndex(ScaffoldVertex v);
+
+    const AdjacencyList &Outgoing(ScaffoldVertex v) const;
 
-    //Delete outgoing edge from adjancecy list without checks
-    void DeleteOutgoing(const ScaffoldEdge &e);
+    const AdjacencyList &Incoming(ScaffoldVertex v) const;
+
+    void AddEdgeSimple(const ScaffoldEdge &e);
 
-    //Delete incoming edge from adjancecy list without checks
-    void DeleteIncoming(const ScaffoldEdge &e);
+    //Position of edge in edge storage or -1 if it does not exist
+    size_t FindEdge(const ScaffoldEdge &e) const;
 
-    //Delete all edge info from storage
-    void DeleteEdgeFromStorage(const ScaffoldEdge &e);
+    //Delete edge from adjacency lists and storage without checks
+    void DeleteEdge(size_t pos);
 
-    //Detelte all outgoing from v edges from  adjacency lists
+    //Detelte all outgoing from v edges
     void DeleteAllOutgoingEdgesSimple(ScaffoldVertex v);
 
-    //Detelte all incoming from v edges from  adjacency lists
+    //Detelte all incoming from v edges
     void DeleteAllIncomingEdgesSimple(ScaffoldVertex v);
 
 public:
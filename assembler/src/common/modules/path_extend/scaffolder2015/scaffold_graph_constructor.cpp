@@ -3,6 +3,7 @@
 //
 
 #include "scaffold_graph_constructor.hpp"
+#include "utils/openmp_wrapper.h"
 
 namespace path_extend {
 namespace scaffold_graph {
@@ -39,16 +40,44 @@ void BaseScaffoldGraphConstructor::ConstructFromConditions(vector<shared_ptr<Con
 
 void BaseScaffoldGraphConstructor::ConstructFromSingleCondition(const shared_ptr<ConnectionCondition> condition,
                                                             bool use_terminal_vertices_only) {
+    //Edges are added only from the vertex being processed, so non-terminal vertices can be skipped beforehand
+    vector<ScaffoldGraph::ScaffoldVertex> sources;
     for (const auto& v : graph_->vertices()) {
-        TRACE("Vertex " << graph_->int_id(v));
-
         if (use_terminal_vertices_only && graph_->OutgoingEdgeCount(v) > 0)
             continue;
+        sources.push_back(v);
+    }
+
+    //Connections are evaluated concurrently and stored in CSR form:
+    //connections of sources[i] are connections[offsets[i]] .. connections[offsets[i + 1] - 1]
+    typedef pair<EdgeId, double> Connection;
+    vector<size_t> offsets(sources.size() + 1, 0);
+    vector<vector<pair<size_t, Connection>>> thread_connections(omp_get_max_threads());
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto &buffer = thread_connections[omp_get_thread_num()];
+        auto connected_with = condition->ConnectedWith(sources[i]);
+        for (const auto& pair : connected_with)
+            buffer.push_back(std::make_pair(i, pair));
+        offsets[i + 1] = connected_with.size();
+    }
+    for (size_t i = 0; i < sources.size(); ++i)
+        offsets[i + 1] += offsets[i];
+
+    vector<Connection> connections(offsets.back());
+    vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+    for (const auto &buffer : thread_connections)
+        for (const auto &entry : buffer)
+            connections[filled[entry.first]++] = entry.second;
+
+    //Edges are added in the same order as by serial construction
+    for (size_t i = 0; i < sources.size(); ++i) {
+        ScaffoldGraph::ScaffoldVertex v = sources[i];
+        TRACE("Vertex " << graph_->int_id(v));
 
-        auto connected_with = condition->ConnectedWith(v);
-        for (const auto& pair : connected_with) {
-            EdgeId connected = pair.first;
-            double w = pair.second;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            EdgeId connected = connections[j].first;
+            double w = connections[j].second;
             TRACE("Connected with " << graph_->int_id(connected));
             if (graph_->Exists(connected)) {
                 if (use_terminal_vertices_only && graph_->IncomingEdgeCount(connected) > 0)
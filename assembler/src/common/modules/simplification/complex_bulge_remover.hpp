@@ -69,6 +69,16 @@ public:
         height_2_vertices_.insert(make_pair(0, start_vertex));
     }
 
+    //restores component from the previously recorded vertex depths
+    LocalizedComponent(const Graph& g, VertexId start_vertex,
+            const map<VertexId, Range>& vertex_depth) :
+            LocalizedComponent(g, start_vertex) {
+        for (const auto& v_depth : vertex_depth) {
+            if (v_depth.first != start_vertex)
+                AddVertex(v_depth.first, v_depth.second);
+        }
+    }
+
     const Graph& g() const {
         return g_;
     }
@@ -260,6 +270,10 @@ public:
         }
     }
 
+    const map<VertexId, Range>& vertex_depth() const {
+        return vertex_depth_;
+    }
+
     const multimap<size_t, VertexId>& height_2_vertices() const {
         return height_2_vertices_;
     }
@@ -1046,54 +1060,170 @@ public:
         return comp_;
     }
 
+    const map<VertexId, Range>& dominated() const {
+        return dominated_;
+    }
+
 private:
     DECL_LOGGER("LocalizedComponentFinder");
 };
 
 template<class Graph>
-class CandidateFinder : public VertexCondition<Graph> {
+class ComplexBulgeRemover : public PersistentAlgorithmBase<Graph> {
     typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+    typedef SmartSetIterator<Graph, VertexId> SmartVertexSet;
+
     size_t max_length_;
     size_t length_diff_;
+    size_t chunk_cnt_;
+    string pics_folder_;
 
-public:
-    CandidateFinder(const Graph& g, size_t max_length, size_t length_diff) : 
-        VertexCondition<Graph>(g), max_length_(max_length), length_diff_(length_diff) {
-    }
+    //analysis results sufficient to project the component without repeating the search
+    struct ComponentInfo : private boost::noncopyable {
+        VertexId v;
+        size_t candidate_cnt;
+        map<VertexId, Range> vertex_depth;
+        set<EdgeId> tree_edges;
+        //vertices (and neighbours of vertices) explored during the search
+        vector<VertexId> footprint;
+
+        ComponentInfo() : candidate_cnt(0) {
+        }
 
-    bool Check(VertexId v) const override {
+        ComponentInfo(ComponentInfo&& that) {
+            *this = std::move(that);
+        }
+
+        ComponentInfo& operator= (ComponentInfo&& that) {
+            v = that.v;
+            candidate_cnt = that.candidate_cnt;
+            vertex_depth = std::move(that.vertex_depth);
+            tree_edges = std::move(that.tree_edges);
+            footprint = std::move(that.footprint);
+            return *this;
+        }
+
+        bool operator< (const ComponentInfo& that) const {
+            return v < that.v;
+        }
+    };
+
+    //read-only, safe to be called concurrently
+    bool AnalyzeVertex(VertexId v, ComponentInfo& info) const {
         const Graph& g = this->g();
+        size_t candidate_cnt = 0;
         LocalizedComponentFinder<Graph> comp_finder(g, max_length_,
                                                     length_diff_, v);
         while (comp_finder.ProceedFurther()) {
+            candidate_cnt++;
             DEBUG("Found component candidate start_v " << g.str(v));
             LocalizedComponent<Graph> component = comp_finder.component();
-            //todo introduce reasonable size bound
-            //if (component.size() > 1000) {
-            //    return false;
-            //}
             ComponentColoring<Graph> coloring(component);
             SkeletonTreeFinder<Graph> tree_finder(component, coloring);
             DEBUG("Looking for a tree");
             if (tree_finder.FindTree()) {
+                info.v = v;
+                info.candidate_cnt = candidate_cnt;
+                info.vertex_depth = component.vertex_depth();
+                info.tree_edges = tree_finder.GetTreeEdges();
+                for (VertexId u : key_set(comp_finder.dominated())) {
+                    for (VertexId n : Neighbours(u)) {
+                        info.footprint.push_back(n);
+                    }
+                }
                 return true;
             }
         }
         return false;
     }
-private:
-    DECL_LOGGER("CBRCandidateFinder");
-};
 
-template<class Graph>
-class ComplexBulgeRemover : public PersistentProcessingAlgorithm<Graph, typename Graph::VertexId> {
-    typedef typename Graph::VertexId VertexId;
-    typedef typename Graph::EdgeId EdgeId;
-    typedef PersistentProcessingAlgorithm<Graph, VertexId> base;
+    std::vector<ComponentInfo> FindComponents() const {
+        DEBUG("Looking for complex bulges (in parallel)");
+        perf_counter perf;
+        auto chunk_iterators = IterationHelper<Graph, VertexId>(this->g()).Chunks(chunk_cnt_);
+        VERIFY(chunk_iterators.size() > 1);
+        std::vector<std::vector<ComponentInfo>> component_buffers(omp_get_max_threads());
 
-    size_t max_length_;
-    size_t length_diff_;
-    string pics_folder_;
+        #pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < chunk_iterators.size() - 1; ++i) {
+            for (auto it = chunk_iterators[i], end = chunk_iterators[i + 1]; it != end; ++it) {
+                ComponentInfo info;
+                if (AnalyzeVertex(*it, info))
+                    component_buffers[omp_get_thread_num()].push_back(std::move(info));
+            }
+        }
+
+        std::vector<ComponentInfo> components;
+        for (auto& component_buffer : component_buffers) {
+            std::copy(std::make_move_iterator(component_buffer.begin()),
+                      std::make_move_iterator(component_buffer.end()),
+                      std::back_inserter(components));
+        }
+        //order is in agreement with the sequential processing
+        std::sort(components.begin(), components.end());
+        DEBUG("Total candidates " << components.size() << " found in " << perf.time() << " seconds");
+        return components;
+    }
+
+    bool CheckInteracting(const ComponentInfo& info, const std::unordered_set<VertexId>& involved_vertices) const {
+        for (VertexId v : info.footprint)
+            if (involved_vertices.count(v))
+                return true;
+        return false;
+    }
+
+    void AccountVertices(const ComponentInfo& info, std::unordered_set<VertexId>& involved_vertices) const {
+        for (VertexId v : info.footprint) {
+            involved_vertices.insert(v);
+            involved_vertices.insert(this->g().conjugate(v));
+        }
+    }
+
+    void RetainIndependentComponents(std::vector<ComponentInfo>& components,
+                                     SmartVertexSet& interacting_vertices) const {
+        DEBUG("Looking for independent components");
+        size_t total_cnt = components.size();
+
+        std::vector<ComponentInfo> filtered;
+        filtered.reserve(components.size());
+        std::unordered_set<VertexId> involved_vertices;
+
+        for (ComponentInfo& info : components) {
+            if (CheckInteracting(info, involved_vertices)) {
+                interacting_vertices.push(info.v);
+            } else {
+                AccountVertices(info, involved_vertices);
+                filtered.push_back(std::move(info));
+            }
+        }
+        components = std::move(filtered);
+
+        DEBUG("Independent cnt " << components.size());
+        DEBUG("Interacting cnt " << interacting_vertices.size());
+        VERIFY(components.size() + interacting_vertices.size() == total_cnt);
+    }
+
+    bool ProjectComponent(LocalizedComponent<Graph>& component, const ComponentColoring<Graph>& coloring,
+                          const set<EdgeId>& tree_edges, size_t candidate_cnt) {
+        SkeletonTree<Graph> tree(component, tree_edges);
+
+        if (!pics_folder_.empty()) {
+            PrintComponent(component, tree,
+                    pics_folder_ + "success/"
+                            + ToString(this->g().int_id(component.start_vertex()))
+                            + "_" + ToString(candidate_cnt) + ".dot");
+        }
+
+        ComponentProjector<Graph> projector(this->g(), component, coloring, tree);
+        if (!projector.ProjectComponent()) {
+            //todo think of stopping the whole process
+            DEBUG("Component can't be projected");
+            return false;
+        }
+        DEBUG("Successfully processed component candidate " << candidate_cnt << " start_v " << this->g().str(component.start_vertex()));
+        return true;
+    }
 
     bool ProcessComponent(LocalizedComponent<Graph>& component,
             size_t candidate_cnt) {
@@ -1103,23 +1233,7 @@ class ComplexBulgeRemover : public PersistentProcessingAlgorithm<Graph, typename
         DEBUG("Looking for a tree");
         if (tree_finder.FindTree()) {
             DEBUG("Tree found");
-            SkeletonTree<Graph> tree(component, tree_finder.GetTreeEdges());
-
-            if (!pics_folder_.empty()) {
-                PrintComponent(component, tree,
-                        pics_folder_ + "success/"
-                                + ToString(this->g().int_id(component.start_vertex()))
-                                + "_" + ToString(candidate_cnt) + ".dot");
-            }
-
-            ComponentProjector<Graph> projector(this->g(), component, coloring, tree);
-            if (!projector.ProjectComponent()) {
-                //todo think of stopping the whole process
-                DEBUG("Component can't be projected");
-                return false;
-            }
-            DEBUG("Successfully processed component candidate " << candidate_cnt << " start_v " << this->g().str(component.start_vertex()));
-            return true;
+            return ProjectComponent(component, coloring, tree_finder.GetTreeEdges(), candidate_cnt);
         } else {
             DEBUG("Failed to find skeleton tree for candidate " << candidate_cnt << " start_v " << this->g().str(component.start_vertex()));
             if (!pics_folder_.empty()) {
@@ -1160,16 +1274,73 @@ class ComplexBulgeRemover : public PersistentProcessingAlgorithm<Graph, typename
         return answer;
     }
 
+    void PostProcess(const std::vector<VertexId>& vertices_to_post_process,
+                     SmartVertexSet& to_process) {
+        for (VertexId p_p : vertices_to_post_process) {
+            //Neighbours(p_p) includes p_p
+            for (VertexId n : Neighbours(p_p)) {
+                to_process.push(n);
+            }
+            this->g().CompressVertex(p_p);
+        }
+    }
+
+    //a bit of hacking:
+    //reverting changes resulting from potentially attempted, but failed split
+    void RevertSplits(SmartVertexSet& added_vertices) {
+        Compressor<Graph> compressor(this->g());
+        for (; !added_vertices.IsEnd(); ++added_vertices) {
+            compressor.CompressVertex(*added_vertices);
+        }
+    }
+
+    bool Process(VertexId v, SmartVertexSet& to_process) {
+        DEBUG("Processing vertex " << this->g().str(v));
+        vector<VertexId> vertices_to_post_process;
+        //a bit of hacking (look further)
+        SmartVertexSet added_vertices(this->g(), true);
+
+        if (InnerProcess(v, vertices_to_post_process)) {
+            PostProcess(vertices_to_post_process, to_process);
+            return true;
+        } else {
+            RevertSplits(added_vertices);
+            return false;
+        }
+    }
+
+    //projects the recorded component, falls back to the usual processing if it can't be projected
+    bool ProcessIndependent(const ComponentInfo& info, SmartVertexSet& to_process) {
+        DEBUG("Processing independent component with start vertex " << this->g().str(info.v));
+        SmartVertexSet added_vertices(this->g(), true);
+        vector<VertexId> vertices_to_post_process;
+        {
+            LocalizedComponent<Graph> component(this->g(), info.v, info.vertex_depth);
+            ComponentColoring<Graph> coloring(component);
+            if (ProjectComponent(component, coloring, info.tree_edges, info.candidate_cnt)) {
+                GraphComponent<Graph> gc = component.AsGraphComponent();
+                std::copy(gc.v_begin(), gc.v_end(), std::back_inserter(vertices_to_post_process));
+            }
+        }
+        if (!vertices_to_post_process.empty()) {
+            PostProcess(vertices_to_post_process, to_process);
+            return true;
+        }
+        RevertSplits(added_vertices);
+        to_process.push(info.v);
+        return false;
+    }
+
 public:
 
-    //track_changes=false leads to every iteration run from scratch
+    //every launch is run from scratch: components are found and analyzed in parallel,
+    //non-overlapping ones are then projected, the rest is processed sequentially
     ComplexBulgeRemover(Graph& g, size_t max_length, size_t length_diff,
                         size_t chunk_cnt, const string& pics_folder = "") :
-            base(g, std::make_shared<omnigraph::ParallelInterestingElementFinder<Graph, VertexId>>(
-                CandidateFinder<Graph>(g, max_length, length_diff), chunk_cnt), 
-                false, std::less<VertexId>(), /*track changes*/false),
+            PersistentAlgorithmBase<Graph>(g),
             max_length_(max_length), 
             length_diff_(length_diff), 
+            chunk_cnt_(chunk_cnt),
             pics_folder_(pics_folder) {
         if (!pics_folder_.empty()) {
 //            remove_dir(pics_folder_);
@@ -1180,30 +1351,29 @@ public:
 
     }
 
-    bool Process(VertexId v) override {
-        DEBUG("Processing vertex " << this->g().str(v));
-        vector<VertexId> vertices_to_post_process;
-        //a bit of hacking (look further)
-        SmartSetIterator<Graph, VertexId> added_vertices(this->g(), true);
+    size_t Run(bool /*force_primary_launch*/ = false) override {
+        std::vector<ComponentInfo> components = FindComponents();
 
-        if (InnerProcess(v, vertices_to_post_process)) {
-            for (VertexId p_p : vertices_to_post_process) {
-                //Neighbours(p_p) includes p_p
-                for (VertexId n : Neighbours(p_p)) {
-                    this->ReturnForConsideration(n);
-                }
-                this->g().CompressVertex(p_p);
-            }
-            return true;
-        } else {
-            //a bit of hacking:
-            //reverting changes resulting from potentially attempted, but failed split
-            Compressor<Graph> compressor(this->g());
-            for (; !added_vertices.IsEnd(); ++added_vertices) {
-                compressor.CompressVertex(*added_vertices);
-            }
-            return false;
+        //new vertices are tracked in the same way as during sequential processing
+        SmartVertexSet to_process(this->g(), true);
+        RetainIndependentComponents(components, to_process);
+
+        perf_counter perf;
+        size_t triggered = 0;
+        for (const ComponentInfo& info : components) {
+            if (ProcessIndependent(info, to_process))
+                triggered++;
+        }
+        DEBUG("Independent components processed in " << perf.time() << " seconds");
+        perf.reset();
+
+        DEBUG("Processing remaining vertices " << to_process.size());
+        for (; !to_process.IsEnd(); ++to_process) {
+            if (Process(*to_process, to_process))
+                triggered++;
         }
+        DEBUG("Remaining vertices processed in " << perf.time() << " seconds");
+        return triggered;
     }
 
 private:
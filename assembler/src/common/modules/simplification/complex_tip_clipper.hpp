@@ -121,42 +121,121 @@ private:
 };
 
 template<class Graph>
-class ComplexTipClipper : public PersistentProcessingAlgorithm<Graph, typename Graph::VertexId> {
+class ComplexTipClipper : public PersistentAlgorithmBase<Graph> {
     typedef typename Graph::VertexId VertexId;
     typedef typename Graph::EdgeId EdgeId;
-    typedef PersistentProcessingAlgorithm<Graph, VertexId> base;
     typedef typename ComponentRemover<Graph>::HandlerF HandlerF;
+    typedef SmartSetIterator<Graph, VertexId> SmartVertexSet;
 
     string pics_folder_;
     ComplexTipFinder<Graph> finder_;
     ComponentRemover<Graph> component_remover_;
+    size_t chunk_cnt_;
 
-public:
-    //track_changes=false leads to every iteration run from scratch
-    ComplexTipClipper(Graph& g, double relative_coverage,
-                      size_t max_edge_len, size_t max_path_len,
-                      size_t chunk_cnt,
-                      const string& pics_folder = "" ,
-                      HandlerF removal_handler = nullptr) :
-            base(g, nullptr, false, std::less<VertexId>(), /*track changes*/false),
-            pics_folder_(pics_folder),
-            finder_(g, relative_coverage, max_edge_len, max_path_len),
-            component_remover_(g, removal_handler) {
-        if (!pics_folder_.empty()) {
-            make_dir(pics_folder_);
+    struct TipInfo : private boost::noncopyable {
+        VertexId v;
+        GraphComponent<Graph> component;
+
+        TipInfo(VertexId v_, GraphComponent<Graph>&& component_) :
+            v(v_), component(std::move(component_)) {
         }
-        this->interest_el_finder_ = std::make_shared<ParallelInterestingElementFinder<Graph, VertexId>>(
-                [&](VertexId v) {return !finder_(v).empty();}, chunk_cnt);
+
+        TipInfo(TipInfo&& that) :
+            v(that.v), component(std::move(that.component)) {
+        }
+
+        TipInfo& operator= (TipInfo&& that) {
+            v = that.v;
+            component = std::move(that.component);
+            return *this;
+        }
+
+        bool operator< (const TipInfo& that) const {
+            return v < that.v;
+        }
+    };
+
+    //component vertices together with their neighbours: everything the finder looked at
+    //and everything the removal (with subsequent compression) can alter
+    std::vector<VertexId> Footprint(const GraphComponent<Graph>& component) const {
+        std::vector<VertexId> answer;
+        for (VertexId v : component.vertices()) {
+            for (EdgeId e : this->g().IncidentEdges(v)) {
+                answer.push_back(this->g().EdgeStart(e));
+                answer.push_back(this->g().EdgeEnd(e));
+            }
+        }
+        return answer;
     }
 
-    bool Process(VertexId v) override {
-        DEBUG("Processing vertex " << this->g().str(v));
-        auto component = finder_(v);
-        if (component.empty()) {
-            DEBUG("Failed to detect complex tip starting with vertex " << this->g().str(v));
-            return false;
+    bool CheckInteracting(const TipInfo& info, const std::unordered_set<VertexId>& involved_vertices) const {
+        for (VertexId v : Footprint(info.component))
+            if (involved_vertices.count(v))
+                return true;
+        return false;
+    }
+
+    void AccountVertices(const TipInfo& info, std::unordered_set<VertexId>& involved_vertices) const {
+        for (VertexId v : Footprint(info.component)) {
+            involved_vertices.insert(v);
+            involved_vertices.insert(this->g().conjugate(v));
+        }
+    }
+
+    std::vector<TipInfo> FindTips() const {
+        DEBUG("Looking for complex tips (in parallel)");
+        perf_counter perf;
+        auto chunk_iterators = IterationHelper<Graph, VertexId>(this->g()).Chunks(chunk_cnt_);
+        VERIFY(chunk_iterators.size() > 1);
+        std::vector<std::vector<TipInfo>> tip_buffers(omp_get_max_threads());
+
+        #pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < chunk_iterators.size() - 1; ++i) {
+            for (auto it = chunk_iterators[i], end = chunk_iterators[i + 1]; it != end; ++it) {
+                auto component = finder_(*it);
+                if (!component.empty())
+                    tip_buffers[omp_get_thread_num()].push_back(TipInfo(*it, std::move(component)));
+            }
+        }
+
+        std::vector<TipInfo> tips;
+        for (auto& tip_buffer : tip_buffers) {
+            std::copy(std::make_move_iterator(tip_buffer.begin()),
+                      std::make_move_iterator(tip_buffer.end()),
+                      std::back_inserter(tips));
+        }
+        //order is in agreement with the sequential processing
+        std::sort(tips.begin(), tips.end());
+        DEBUG("Total tips " << tips.size() << " found in " << perf.time() << " seconds");
+        return tips;
+    }
+
+    SmartVertexSet RetainIndependentTips(std::vector<TipInfo>& tips) const {
+        DEBUG("Looking for independent tips");
+        size_t total_cnt = tips.size();
+
+        std::vector<TipInfo> filtered;
+        filtered.reserve(tips.size());
+        std::unordered_set<VertexId> involved_vertices;
+        SmartVertexSet interacting_vertices(this->g());
+
+        for (TipInfo& info : tips) {
+            if (CheckInteracting(info, involved_vertices)) {
+                interacting_vertices.push(info.v);
+            } else {
+                AccountVertices(info, involved_vertices);
+                filtered.push_back(std::move(info));
+            }
         }
+        tips = std::move(filtered);
 
+        DEBUG("Independent cnt " << tips.size());
+        DEBUG("Interacting cnt " << interacting_vertices.size());
+        VERIFY(tips.size() + interacting_vertices.size() == total_cnt);
+        return interacting_vertices;
+    }
+
+    void RemoveTip(VertexId v, const GraphComponent<Graph>& component) {
         if (!pics_folder_.empty()) {
             visualization::visualization_utils::WriteComponentSinksSources(component,
                                                       pics_folder_
@@ -168,9 +247,65 @@ public:
         DEBUG("Detected tip component edge cnt: " << component.e_size());
         component_remover_.DeleteComponent(component.e_begin(), component.e_end());
         DEBUG("Complex tip removed");
+    }
+
+    bool Process(VertexId v) {
+        DEBUG("Processing vertex " << this->g().str(v));
+        auto component = finder_(v);
+        if (component.empty()) {
+            DEBUG("Failed to detect complex tip starting with vertex " << this->g().str(v));
+            return false;
+        }
+        RemoveTip(v, component);
         return true;
     }
 
+    size_t ProcessTips(const std::vector<TipInfo>& independent_tips, SmartVertexSet&& interacting_vertices) {
+        perf_counter perf;
+        size_t triggered = 0;
+        //removal of an independent tip can not affect the footprint of any other independent tip
+        for (const TipInfo& info : independent_tips) {
+            RemoveTip(info.v, info.component);
+            triggered++;
+        }
+        DEBUG("Independent tips removed in " << perf.time() << " seconds");
+        perf.reset();
+
+        DEBUG("Processing remaining interacting tips " << interacting_vertices.size());
+        for (; !interacting_vertices.IsEnd(); ++interacting_vertices) {
+            if (Process(*interacting_vertices))
+                triggered++;
+        }
+        DEBUG("Interacting tips processed in " << perf.time() << " seconds");
+        return triggered;
+    }
+
+public:
+    //every launch is run from scratch: candidate tips are found (and analyzed) in parallel,
+    //non-overlapping ones are then removed, overlapping ones are rechecked sequentially
+    ComplexTipClipper(Graph& g, double relative_coverage,
+                      size_t max_edge_len, size_t max_path_len,
+                      size_t chunk_cnt,
+                      const string& pics_folder = "" ,
+                      HandlerF removal_handler = nullptr) :
+            PersistentAlgorithmBase<Graph>(g),
+            pics_folder_(pics_folder),
+            finder_(g, relative_coverage, max_edge_len, max_path_len),
+            component_remover_(g, removal_handler),
+            chunk_cnt_(chunk_cnt) {
+        if (!pics_folder_.empty()) {
+            make_dir(pics_folder_);
+        }
+    }
+
+    size_t Run(bool /*force_primary_launch*/ = false) override {
+        std::vector<TipInfo> tips = FindTips();
+        auto interacting_vertices = RetainIndependentTips(tips);
+        size_t triggered = ProcessTips(tips, std::move(interacting_vertices));
+        DEBUG("Complex tips removed " << triggered);
+        return triggered;
+    }
+
 private:
     DECL_LOGGER("ComplexTipClipper")
 };
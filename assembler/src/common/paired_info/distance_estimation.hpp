@@ -15,6 +15,11 @@
 #include "assembly_graph/paths/path_processor.hpp"
 #include "paired_info/pair_info_bounds.hpp"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace omnigraph {
 
 namespace de {
@@ -27,11 +32,33 @@ class GraphDistanceFinder {
     typedef std::vector<EdgeId> Path;
     typedef std::vector<size_t> GraphLengths;
     typedef std::map<EdgeId, GraphLengths> LengthMap;
+    typedef std::pair<VertexId, VertexId> VertexPair;
+
+    struct VertexPairHash {
+        size_t operator()(const VertexPair &p) const {
+            return std::hash<VertexId>()(p.first) * 31 + std::hash<VertexId>()(p.second);
+        }
+    };
+
+    // Path lengths between vertex pairs, shared by all threads.
+    // Each shard is guarded by its own lock.
+    struct CacheShard {
+        std::mutex lock;
+        std::unordered_map<VertexPair, GraphLengths, VertexPairHash> lengths;
+    };
+
+    static const size_t CACHE_SHARD_CNT = 64;
 
 public:
-    GraphDistanceFinder(const Graph &graph, size_t insert_size, size_t read_length, size_t delta) :
+    /*
+     * @param max_cache_size - bound on the total number of vertex pairs and path lengths kept in cache,
+     * vertex pairs without paths are cached too
+     */
+    GraphDistanceFinder(const Graph &graph, size_t insert_size, size_t read_length, size_t delta,
+                        size_t max_cache_size = 1 << 22) :
             graph_(graph), insert_size_(insert_size), gap_((int) (insert_size - 2 * read_length)),
-            delta_((double) delta) { }
+            delta_((double) delta), max_cache_size_(max_cache_size),
+            cache_(CACHE_SHARD_CNT), cache_size_(0), cached_lengths_(0), hits_(0), misses_(0) { }
 
     std::vector<size_t> GetGraphDistancesLengths(EdgeId e1, EdgeId e2) const {
         LengthMap m;
@@ -44,11 +71,10 @@ public:
 
     // finds all distances from a current edge to a set of edges
     void FillGraphDistancesLengths(EdgeId e1, LengthMap &second_edges) const {
-        vector<size_t> path_lower_bounds;
-
         size_t path_upper_bound = PairInfoPathLengthUpperBound(graph_.k(), insert_size_, delta_);
 
-        PathProcessor<Graph> paths_proc(graph_, graph_.EdgeEnd(e1), path_upper_bound);
+        // Dijkstra is launched only if some of the vertex pairs are not cached
+        std::unique_ptr<PathProcessor<Graph>> paths_proc;
 
         for (auto &entry : second_edges) {
             EdgeId e2 = entry.first;
@@ -57,9 +83,10 @@ public:
 
             TRACE("Bounds for paths are " << path_lower_bound << " " << path_upper_bound);
 
-            DistancesLengthsCallback<Graph> callback(graph_);
-            paths_proc.Process(graph_.EdgeStart(e2), path_lower_bound, path_upper_bound, callback);
-            GraphLengths lengths = callback.distances();
+            const GraphLengths all_lengths = PathLengths(graph_.EdgeEnd(e1), graph_.EdgeStart(e2),
+                                                         path_upper_bound, paths_proc);
+            GraphLengths lengths(std::lower_bound(all_lengths.begin(), all_lengths.end(), path_lower_bound),
+                                 all_lengths.end());
             for (size_t j = 0; j < lengths.size(); ++j) {
                 lengths[j] += graph_.length(e1);
                 TRACE("Resulting distance set for " <<
@@ -75,13 +102,63 @@ public:
         }
     }
 
+    void ReportCacheStats() const {
+        size_t hits = hits_, total = hits_ + misses_;
+        INFO("Graph distance cache: " << hits << " hits of " << total << " queries ("
+             << (total ? 100. * double(hits) / double(total) : 0.) << "%), "
+             << cached_lengths_ << " path lengths cached, cache size " << cache_size_);
+    }
+
 private:
     DECL_LOGGER("GraphDistanceFinder");
 
+    // Sorted lengths of all paths from start to end which are not longer than upper bound.
+    // Path enumeration prunes only by the upper bound (lower bound merely filters the reported paths),
+    // so lengths are cached per vertex pair and filtered by the lower bound of a particular edge pair.
+    GraphLengths PathLengths(VertexId start, VertexId end, size_t upper_bound,
+                             std::unique_ptr<PathProcessor<Graph>> &paths_proc) const {
+        VertexPair key(start, end);
+        CacheShard &shard = cache_[VertexPairHash()(key) % CACHE_SHARD_CNT];
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            auto it = shard.lengths.find(key);
+            if (it != shard.lengths.end()) {
+                ++hits_;
+                return it->second;
+            }
+        }
+        ++misses_;
+
+        if (!paths_proc)
+            paths_proc.reset(new PathProcessor<Graph>(graph_, start, upper_bound));
+        DistancesLengthsCallback<Graph> callback(graph_);
+        paths_proc->Process(end, 0, upper_bound, callback);
+        GraphLengths lengths = callback.distances();
+
+        //every entry counts, so that pairs without paths do not grow the cache without bound
+        size_t entry_size = 1 + lengths.size();
+        if (cache_size_ + entry_size <= max_cache_size_) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            if (shard.lengths.insert({key, lengths}).second) {
+                cache_size_ += entry_size;
+                cached_lengths_ += lengths.size();
+            }
+        }
+        return lengths;
+    }
+
     const Graph &graph_;
     const size_t insert_size_;
     const int gap_;
     const double delta_;
+    const size_t max_cache_size_;
+
+    // valid as long as the graph is not modified
+    mutable std::vector<CacheShard> cache_;
+    mutable std::atomic<size_t> cache_size_;
+    mutable std::atomic<size_t> cached_lengths_;
+    mutable std::atomic<size_t> hits_;
+    mutable std::atomic<size_t> misses_;
 };
 
 template<class Graph>
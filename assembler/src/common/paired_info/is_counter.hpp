@@ -16,7 +16,14 @@ namespace debruijn_graph {
 
 using namespace omnigraph;
 
+/*
+ * Insert sizes within [0, MAX_DENSE_IS) are counted in dense per-thread arrays,
+ * which are cheap to update and are merged by a plain vectorizable loop.
+ * Remaining (negative or very large) insert sizes are kept in sparse histograms.
+ */
 class InsertSizeCounter: public SequenceMapperListener {
+    static constexpr int MAX_DENSE_IS = 1 << 16;
+    typedef std::vector<size_t> DenseHist;
 
 public:
 
@@ -25,7 +32,8 @@ public:
             bool ignore_negative = false)
         : gp_(gp), 
           edge_length_threshold_(edge_length_threshold),
-          ignore_negative_(ignore_negative) {
+          ignore_negative_(ignore_negative),
+          merged_count_(0), last_median_(-1) {
     }
 
     HistType hist() { return hist_; }
@@ -37,6 +45,11 @@ public:
     void StartProcessLibrary(size_t threads_count) override {
         hist_.clear();
         tmp_hists_ = vector<HistType>(threads_count);
+        dense_hist_.assign(MAX_DENSE_IS, 0);
+        tmp_dense_hists_ = vector<DenseHist>(threads_count, DenseHist(MAX_DENSE_IS, 0));
+        dense_ends_.assign(threads_count, 0);
+        merged_count_ = 0;
+        last_median_ = -1;
 
         total_ = count_data(threads_count);
         counted_ = count_data(threads_count);
@@ -44,7 +57,13 @@ public:
     }
 
     void StopProcessLibrary() override {
+        for (int is = 0; is < MAX_DENSE_IS; ++is)
+            if (dense_hist_[is])
+                hist_[is] += dense_hist_[is];
+
         tmp_hists_.clear();
+        tmp_dense_hists_.clear();
+        DenseHist().swap(dense_hist_);
         total_.merge();
         counted_.merge();
         negative_.merge();
@@ -67,10 +86,40 @@ public:
     }
 
     void MergeBuffer(size_t thread_index) override {
-        for (const auto& kv: tmp_hists_[thread_index])
+        for (const auto& kv: tmp_hists_[thread_index]) {
             hist_[kv.first] += kv.second;
-
+            merged_count_ += kv.second;
+        }
         tmp_hists_[thread_index].clear();
+
+        size_t *__restrict dst = dense_hist_.data();
+        size_t *__restrict src = tmp_dense_hists_[thread_index].data();
+        size_t end = dense_ends_[thread_index], added = 0;
+        for (size_t i = 0; i < end; ++i) {
+            dst[i] += src[i];
+            added += src[i];
+            src[i] = 0;
+        }
+        merged_count_ += added;
+        dense_ends_[thread_index] = 0;
+    }
+
+    /*
+     * Checks whether the histogram merged so far is a sufficient sample:
+     * at least min_sample insert sizes are counted and the running median moved
+     * by at most rel_tolerance (relatively) since the previous check.
+     * Should be called between MergeBuffer calls.
+     */
+    bool Converged(size_t min_sample, double rel_tolerance) {
+        if (merged_count_ < min_sample)
+            return false;
+
+        double median = MergedMedian();
+        bool converged = last_median_ >= 0 &&
+                std::abs(median - last_median_) <= rel_tolerance * std::max(median, 1.);
+        DEBUG("Insert size sample " << merged_count_ << ", running median " << median);
+        last_median_ = median;
+        return converged;
     }
 
     void FindMean(double& mean, double& delta, std::map<size_t, size_t>& percentiles) const {
@@ -104,7 +153,12 @@ private:
             TRACE("IS: " << read2_start << " - " <<  read1_start << " + " << (int) is_delta << " = " << is);
 
             if (is > 0 || ignore_negative_) {
-                tmp_hists_[thread_index][is] += 1;
+                if (is >= 0 && is < MAX_DENSE_IS) {
+                    tmp_dense_hists_[thread_index][is] += 1;
+                    dense_ends_[thread_index] = std::max(dense_ends_[thread_index], size_t(is) + 1);
+                } else {
+                    tmp_hists_[thread_index][is] += 1;
+                }
                 ++counted_.arr_[thread_index];
             } else {
                 ++negative_.arr_[thread_index];
@@ -113,6 +167,30 @@ private:
         }
 
     }
+
+    // Same as get_median over the merged (dense and sparse) histogram
+    double MergedMedian() const {
+        double half = (double) merged_count_ / 2;
+        double rest = (double) merged_count_;
+        auto it = hist_.begin();
+        for (; it != hist_.end() && it->first < 0; ++it) {
+            rest -= (double) it->second;
+            if (rest <= half)
+                return it->first;
+        }
+        for (int is = 0; is < MAX_DENSE_IS; ++is) {
+            rest -= (double) dense_hist_[is];
+            if (rest <= half)
+                return is;
+        }
+        for (; it != hist_.end(); ++it) {
+            rest -= (double) it->second;
+            if (rest <= half)
+                return it->first;
+        }
+        return -1;
+    }
+
     struct count_data {
       size_t total_;
       vector<size_t> arr_;
@@ -135,6 +213,9 @@ private:
 
     HistType hist_;
     vector<HistType> tmp_hists_;
+    DenseHist dense_hist_;
+    vector<DenseHist> tmp_dense_hists_;
+    vector<size_t> dense_ends_;
 
     count_data total_;
     count_data counted_;
@@ -142,8 +223,26 @@ private:
 
     size_t edge_length_threshold_;
     bool ignore_negative_;
+
+    size_t merged_count_;
+    double last_median_;
 };
 
+/*
+ * Estimates the number of distinct edge pairs in a library of total_pairs read pairs,
+ * sample_edgepairs distinct edge pairs being found in its first sample_pairs read pairs.
+ * The number of distinct edge pairs grows sublinearly, so linear extrapolation gives an upper bound.
+ * The estimate is capped by limit, but never gets below the sample count.
+ */
+inline size_t ExtrapolateEdgePairs(size_t sample_edgepairs, size_t sample_pairs,
+                                   size_t total_pairs, size_t limit) {
+    if (sample_pairs >= total_pairs)
+        return sample_edgepairs;
+    size_t extrapolated = size_t((double) sample_edgepairs * (double) total_pairs /
+                                 (double) std::max<size_t>(sample_pairs, 1));
+    return std::max(sample_edgepairs, std::min(extrapolated, limit));
+}
+
 }
 
 
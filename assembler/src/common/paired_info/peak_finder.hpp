@@ -23,11 +23,138 @@
 #include <time.h>
 #include <complex>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 namespace  omnigraph{
 
 namespace de {
 
+/*
+ * FFT of real sequences of length n = 2^lg_n computed via complex FFT of length n / 2.
+ * Bit reversal permutation and twiddle factors are computed once per length,
+ * plans are cached per thread (see ForLength).
+ */
+class RealFFT {
+    typedef std::complex<double> complex_t;
+
+    size_t n_;
+    std::vector<size_t> rev_;        // bit reversal permutation of n / 2 elements
+    std::vector<complex_t> roots_;   // exp(-2 pi i j / (n / 2)), j < n / 4
+    std::vector<complex_t> unpack_;  // exp(-2 pi i k / n), k <= n / 2
+
+    static complex_t Mul(const complex_t &a, const complex_t &b) {
+        return complex_t(a.real() * b.real() - a.imag() * b.imag(),
+                         a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    // in-place complex FFT of the first n / 2 elements, inverse is not normalized
+    void Transform(std::vector<complex_t> &a, bool invert) const {
+        size_t m = n_ / 2;
+        for (size_t i = 0; i < m; ++i)
+            if (i < rev_[i])
+                std::swap(a[i], a[rev_[i]]);
+
+        for (size_t len = 2; len <= m; len <<= 1) {
+            size_t half = len >> 1, step = m / len;
+            for (size_t i = 0; i < m; i += len) {
+                complex_t *lo = &a[i], *hi = &a[i + half];
+                for (size_t j = 0; j < half; ++j) {
+                    complex_t w = roots_[j * step];
+                    if (invert)
+                        w = std::conj(w);
+                    complex_t u = lo[j], v = Mul(hi[j], w);
+                    lo[j] = u + v;
+                    hi[j] = u - v;
+                }
+            }
+        }
+    }
+
+public:
+    explicit RealFFT(size_t lg_n)
+            : n_(size_t(1) << lg_n) {
+        VERIFY(lg_n > 0);
+        size_t m = n_ / 2, lg_m = lg_n - 1;
+        rev_.resize(m);
+        for (size_t i = 0; i < m; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < lg_m; ++b)
+                if (i & (size_t(1) << b))
+                    r |= size_t(1) << (lg_m - 1 - b);
+            rev_[i] = r;
+        }
+        for (size_t j = 0; j < m / 2; ++j)
+            roots_.push_back(std::polar(1., -2 * M_PI * (double) j / (double) m));
+        for (size_t k = 0; k <= m; ++k)
+            unpack_.push_back(std::polar(1., -2 * M_PI * (double) k / (double) n_));
+    }
+
+    // plan for the shortest power of two not less than len
+    static const RealFFT &ForLength(size_t len) {
+        static thread_local std::vector<std::unique_ptr<RealFFT>> plans;
+        size_t lg_n = 1;
+        while ((size_t(1) << lg_n) < len)
+            ++lg_n;
+        if (plans.size() <= lg_n)
+            plans.resize(lg_n + 1);
+        if (!plans[lg_n])
+            plans[lg_n].reset(new RealFFT(lg_n));
+        return *plans[lg_n];
+    }
+
+    size_t size() const {
+        return n_;
+    }
+
+    /*
+     * Spectrum bins 0..n/2 of data zero padded to n, the rest are complex conjugate.
+     * @param packed - working buffer
+     */
+    void Forward(const std::vector<double> &data, std::vector<complex_t> &packed,
+                 std::vector<complex_t> &spectrum) const {
+        size_t m = n_ / 2;
+        VERIFY(data.size() <= n_);
+        packed.assign(m, 0.);
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (i & 1)
+                packed[i >> 1].imag(data[i]);
+            else
+                packed[i >> 1].real(data[i]);
+        }
+        Transform(packed, false);
+
+        spectrum.resize(m + 1);
+        for (size_t k = 0; k <= m; ++k) {
+            complex_t z = packed[k % m], zc = std::conj(packed[(m - k) % m]);
+            complex_t even = (z + zc) * .5, odd = Mul(z - zc, complex_t(0., -.5));
+            spectrum[k] = even + Mul(unpack_[k], odd);
+        }
+    }
+
+    /*
+     * Inverse of Forward, first data.size() elements of the real sequence are written to data.
+     * @param packed - working buffer
+     */
+    void Backward(const std::vector<complex_t> &spectrum, std::vector<complex_t> &packed,
+                  std::vector<double> &data) const {
+        size_t m = n_ / 2;
+        VERIFY(spectrum.size() == m + 1 && data.size() <= n_);
+        packed.resize(m);
+        for (size_t k = 0; k < m; ++k) {
+            complex_t x = spectrum[k], xc = std::conj(spectrum[m - k]);
+            complex_t even = (x + xc) * .5, odd = Mul((x - xc) * .5, std::conj(unpack_[k]));
+            packed[k] = even + complex_t(-odd.imag(), odd.real());
+        }
+        Transform(packed, true);
+
+        for (size_t i = 0; i < data.size(); ++i) {
+            complex_t z = packed[i >> 1];
+            data[i] = ((i & 1) ? z.imag() : z.real()) / (double) m;
+        }
+    }
+};
+
 template <class EdgeId>
 class PeakFinder {
 
@@ -73,17 +200,18 @@ class PeakFinder {
     }
     InitBaseline();
     SubtractBaseline();
-    FFTForward(hist_);
     size_t Ncrit = (size_t) (cutoff);
 
     //      cutting off - standard parabolic filter
-    for (size_t i = 0; i < data_len_ && i < Ncrit; ++i)
-      hist_[i] *= 1. - ((double) i * (double) i * 1.) / (double) (Ncrit * Ncrit);
-
-    for (size_t i = Ncrit; i < hist_.size(); ++i)
-      hist_[i] = 0.;
-
-    FFTBackward(hist_);
+    //      it is applied to positive frequencies only and the real part of the result is taken,
+    //      which is the same as applying its symmetrized version to the spectrum of real data
+    static thread_local vector<complex_t> packed, spectrum;
+    const RealFFT &fft = RealFFT::ForLength(data_len_);
+    size_t n = fft.size();
+    fft.Forward(hist_, packed, spectrum);
+    for (size_t i = 0; i < spectrum.size(); ++i)
+      spectrum[i] *= .5 * (FilterGain(i, Ncrit) + FilterGain((n - i) % n, Ncrit));
+    fft.Backward(spectrum, packed, hist_);
     AddBaseline();
   }
 
@@ -101,11 +229,11 @@ class PeakFinder {
     //size_t index_max = 0;
     //for (size_t i = 0; i < data_len_; ++i) {
     //TRACE(x_left_ + (int) i << " " << hist_[i]);
-    //if (hist_[i].real() > hist_[index_max].real())
+    //if (hist_[i] > hist_[index_max])
     //index_max = i;
     //}
     //vector<pair<int, double> > result;
-    //result.push_back(make_pair(x_left_ + index_max, hist_[index_max].real()));
+    //result.push_back(make_pair(x_left_ + index_max, hist_[index_max]));
     //return result;
     DEBUG("Listing peaks");
     map<int, double> peaks_;
@@ -164,7 +292,7 @@ class PeakFinder {
         int left_bound = (x_left_ > (index - 20) ? x_left_ : (index - 20));
         int right_bound = (x_right_ < (index + 1 + 20) ? x_right_ : (index + 1 + 20));
         for (int i = left_bound; i < right_bound; ++i)
-          weight_ += hist_[i - x_left_].real();
+          weight_ += hist_[i - x_left_];
         TRACE("WEIGHT counted");
         pair<int, double> tmp_pair = make_pair(index, 100. * weight_);
         if (!peaks_.count(index)) {
@@ -188,14 +316,6 @@ class PeakFinder {
     return peaks;
   }
 
-    vector<complex_t> getIn() const {
-        return hist_;
-    }
-
-    vector<complex_t> getOut() const {
-        return hist_;
-    }
-
 private:
   double x1, x2, y1, y2;
   size_t delta_;
@@ -206,61 +326,18 @@ private:
   vector<double> y_;
   size_t data_size_, data_len_;
   int x_left_, x_right_;
-  vector<complex_t> hist_;
-
-  size_t Rev(size_t num, size_t lg_n) {
-    size_t res = 0;
-    for (size_t i = 0; i < lg_n; ++i)
-      if (num & (1 << i))
-        res |= 1 << (lg_n - 1 - i);
-    return res;
-  }
-
-  void FFT(vector<complex_t>& vect, bool invert) {
-    size_t n = vect.size();
-    size_t lg_n = 0;
-    while ( (1u << lg_n) < n)
-      ++lg_n;
-
-    while (n < (1u << lg_n)) {
-      vect.push_back(0.);
-      ++n;
-    }
-
-    for (size_t i = 0; i < n; ++i)
-      if (i < Rev(i, lg_n))
-        swap(vect[i], vect[Rev(i, lg_n)]);
-
-    for (size_t len = 2; len < 1 + n; len <<= 1) {
-      double ang = 2 * M_PI / (double) len * (invert ? -1 : 1);
-      complex_t wlen(cos(ang), sin(ang));
-      for (size_t i = 0; i < n; i += len) {
-        complex_t w(1.);
-        for (size_t j = 0; j < (len >> 1); ++j) {
-          complex_t u = vect[i + j];
-          complex_t v = vect[i + j + (len >> 1)] * w;
-          vect[i + j] = u + v;
-          vect[i + j + (len >> 1)] = u - v;
-          w *= wlen;
-        }
-      }
-    }
-
-    if (invert)
-      for (size_t i = 0; i < n; ++i)
-        vect[i] /= (double) n;
-  }
-
-
-  void FFTForward(vector<complex_t>& vect) {
-    FFT(vect, false);
-  }
-
-  void FFTBackward(vector<complex_t>& vect) {
-    FFT(vect, true);
+  vector<double> hist_;
+
+  //  gain of the parabolic filter at frequency i
+  double FilterGain(size_t i, size_t Ncrit) const {
+    if (i >= Ncrit)
+      return 0.;
+    if (i >= data_len_)
+      return 1.;
+    return 1. - ((double) i * (double) i * 1.) / (double) (Ncrit * Ncrit);
   }
 
-  void ExtendLinear(vector<complex_t>& hist) {
+  void ExtendLinear(vector<double>& hist) {
     size_t ind = 0;
     weight_ = 0.;
     for (size_t i = 0; i < data_len_; ++i) {
@@ -273,7 +350,7 @@ private:
                         (double) (x_[ind + 1] - i - x_left_)) /
                         (double) (1 * (x_[ind + 1] - x_[ind])));
       }
-      weight_ += hist[i].real();     // filling the array on the fly
+      weight_ += hist[i];     // filling the array on the fly
 
       if (ind < data_size_ && ((int) i == x_[ind + 1] - x_left_))
         ++ind;
@@ -289,8 +366,8 @@ private:
     double mean_beg = 0.;
     double mean_end = 0.;
     for (size_t i = 0; i < Np; ++i) {
-      mean_beg += hist_[i].real();
-      mean_end += hist_[data_len_ - i - 1].real();
+      mean_beg += hist_[i];
+      mean_end += hist_[data_len_ - i - 1];
     }
     mean_beg /= 1. * (double) Np;
     mean_end /= 1. * (double) Np;
@@ -331,17 +408,17 @@ private:
 
   double LeftDerivative(int dist) const {
     VERIFY(dist > x_left_);
-    return hist_[dist - x_left_].real() - hist_[dist - x_left_ - 1].real();
+    return hist_[dist - x_left_] - hist_[dist - x_left_ - 1];
   }
 
   double RightDerivative(int dist) const {
     VERIFY(dist < x_right_ - 1);
-    return hist_[dist - x_left_ + 1].real() - hist_[dist - x_left_].real();
+    return hist_[dist - x_left_ + 1] - hist_[dist - x_left_];
   }
 
   double MiddleDerivative(int dist) const {
     VERIFY(dist > x_left_ && dist < x_right_ - 1);
-    return .5 * (hist_[dist - x_left_ + 1].real() - hist_[dist - x_left_ - 1].real());
+    return .5 * (hist_[dist - x_left_ + 1] - hist_[dist - x_left_ - 1]);
   }
 
   double Derivative(int dist) const {
@@ -360,7 +437,7 @@ private:
     int index_max = peak;
     TRACE("Looking for the maximum");
     for (int j = left_bound; j < right_bound; ++j)
-      if (math::ls(hist_[index_max - x_left_].real(), hist_[j - x_left_].real())) {
+      if (math::ls(hist_[index_max - x_left_], hist_[j - x_left_])) {
         index_max = j;
       }// else if (j < i && hist_[index_max - x_left_][0] == hist_[j - x_left][0] ) index_max = j;
     TRACE("Maximum is " << index_max);
@@ -394,6 +394,8 @@ void load(debruijn_config::distance_estimator& de,
   load(de.raw_filter_threshold, pt, "raw_filter_threshold", complete);
   load(de.rounding_coeff, pt, "rounding_coeff", complete);
   load(de.rounding_thr, pt, "rounding_threshold", complete);
+  load(de.is_sample_size, pt, "is_sample_size", false);
+  load(de.is_sample_tolerance, pt, "is_sample_tolerance", false);
 }
 
 void load(debruijn_config::smoothing_distance_estimator& ade,
@@ -499,6 +501,7 @@ void load(debruijn_config::gap_closer& gc,
   load(gc.in_simplify, pt, "in_simplify");
   load(gc.after_simplify, pt, "after_simplify");
   load(gc.weight_threshold, pt, "weight_threshold");
+  load(gc.parallel, pt, "parallel", false);
 }
 
 void load(debruijn_config::contig_output& co,
@@ -568,6 +571,7 @@ void load(debruijn_config::simplification& simp,
   using config_common::load;
 
   load(simp.cycle_iter_count, pt, "cycle_iter_count", complete);
+  load(simp.cycle_buff_size, pt, "cycle_buff_size", false);
 
   load(simp.post_simplif_enabled, pt, "post_simplif_enabled", complete);
   load(simp.topology_simplif_enabled, pt, "topology_simplif_enabled", complete);
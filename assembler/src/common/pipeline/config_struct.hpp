@@ -327,6 +327,9 @@ struct debruijn_config {
         };
 
         size_t cycle_iter_count;
+        //tip clipper and ec remover of the basic cycle check candidates in parallel
+        //in buffers of cycle_buff_size edges, 0 means one by one
+        size_t cycle_buff_size = 0;
 
         bool post_simplif_enabled;
         bool topology_simplif_enabled;
@@ -386,6 +389,10 @@ struct debruijn_config {
         unsigned raw_filter_threshold;
         double rounding_thr;
         double rounding_coeff;
+        //insert size is estimated over a sample of at least is_sample_size aligned pairs
+        //(until its median is stable within is_sample_tolerance), 0 means all reads
+        size_t is_sample_size = 0;
+        double is_sample_tolerance = 0.01;
     };
 
     struct smoothing_distance_estimator {
@@ -449,6 +456,7 @@ struct debruijn_config {
         bool in_simplify;
         bool after_simplify;
         double weight_threshold;
+        bool parallel = false;
     };
 
     struct info_printer {
@@ -0,0 +1,157 @@
+//***************************************************************************
+//* Copyright (c) 2016 Saint Petersburg State University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/verify.hpp"
+
+#include <cstdint>
+#include <cstddef>
+
+/*
+ * Digest of a k-mer produced by RollingHash: two independent 61-bit hashes.
+ */
+struct KMerDigest {
+    uint64_t h[2];
+
+    bool operator==(const KMerDigest &other) const {
+        return h[0] == other.h[0] && h[1] == other.h[1];
+    }
+
+    bool operator!=(const KMerDigest &other) const {
+        return !(*this == other);
+    }
+
+    bool operator<(const KMerDigest &other) const {
+        return h[0] != other.h[0] ? h[0] < other.h[0] : h[1] < other.h[1];
+    }
+};
+
+/*
+ * Polynomial (Rabin-Karp) hash of nucleotide sequences modulo the Mersenne prime 2^61 - 1,
+ * computed for two bases. Nucleotide at position i of a k-mer contributes (c + 1) * B^(k - 1 - i),
+ * hence digest of a k-mer is updated in O(1) when the k-mer is shifted by a single nucleotide.
+ * Unlike rotate-and-xor hashes (ntHash) the digest is not linear over GF(2), so k-mers
+ * differing in structured sets of positions do not collide systematically for any k.
+ */
+class RollingHash {
+    static const uint64_t kPrime = (uint64_t(1) << 61) - 1;
+    static const size_t kMaxK = 1024;
+
+    struct Powers {
+        uint64_t pow[2][kMaxK];
+        uint64_t inv[2];
+
+        Powers() {
+            for (size_t i = 0; i < 2; ++i) {
+                pow[i][0] = 1;
+                for (size_t j = 1; j < kMaxK; ++j)
+                    pow[i][j] = Mul(pow[i][j - 1], Base(i));
+                inv[i] = Pow(Base(i), kPrime - 2);
+            }
+        }
+    };
+
+    static const Powers &powers() {
+        static const Powers res;
+        return res;
+    }
+
+    static uint64_t Base(size_t i) {
+        static const uint64_t bases[2] = {0x0d2b8f1e6c3a5b47ULL, 0x16a09e667f3bcc90ULL};
+        return bases[i];
+    }
+
+    static uint64_t Mul(uint64_t a, uint64_t b) {
+        __uint128_t r = (__uint128_t) a * b;
+        uint64_t res = (uint64_t(r) & kPrime) + uint64_t(r >> 61);
+        return res >= kPrime ? res - kPrime : res;
+    }
+
+    static uint64_t Add(uint64_t a, uint64_t b) {
+        uint64_t res = a + b;
+        return res >= kPrime ? res - kPrime : res;
+    }
+
+    static uint64_t Sub(uint64_t a, uint64_t b) {
+        return a >= b ? a - b : a + kPrime - b;
+    }
+
+    static uint64_t Pow(uint64_t a, uint64_t n) {
+        uint64_t res = 1;
+        for (; n; n >>= 1, a = Mul(a, a)) {
+            if (n & 1)
+                res = Mul(res, a);
+        }
+        return res;
+    }
+
+    //B^(k-1), the weight of the first nucleotide of a k-mer
+    static uint64_t Lead(size_t i, size_t k) {
+        VERIFY(k > 0 && k <= kMaxK);
+        return powers().pow[i][k - 1];
+    }
+
+    static uint64_t Value(char c) {
+        return uint64_t(c) + 1;
+    }
+
+    template<class Nucls>
+    static void Compute(const Nucls &nucls, size_t k, KMerDigest &fwd, KMerDigest &rc) {
+        VERIFY(k <= kMaxK);
+        for (size_t i = 0; i < 2; ++i) {
+            uint64_t f = 0, r = 0;
+            for (size_t pos = 0; pos < k; ++pos)
+                f = Add(Mul(f, Base(i)), Value(nucls(pos)));
+            for (size_t pos = k; pos-- > 0; )
+                r = Add(Mul(r, Base(i)), Value(char(3 - nucls(pos))));
+            fwd.h[i] = f;
+            rc.h[i] = r;
+        }
+    }
+
+public:
+    /*
+     * Digests of a sequence with operator[] returning 0123 chars and of its reverse complement.
+     */
+    template<class Seq>
+    static void Digests(const Seq &s, KMerDigest &fwd, KMerDigest &rc) {
+        Compute([&s](size_t pos) { return char(s[pos]); }, s.size(), fwd, rc);
+    }
+
+    /*
+     * Digests of a packed k-mer of length k and of its reverse complement.
+     */
+    template<class DataType>
+    static void Digests(const DataType *data, size_t k, KMerDigest &fwd, KMerDigest &rc) {
+        const size_t TNucl = sizeof(DataType) * 4;
+        Compute([data, TNucl](size_t pos) { return char((data[pos / TNucl] >> ((pos % TNucl) * 2)) & 3); },
+                k, fwd, rc);
+    }
+
+    /*
+     * Digest shared by a k-mer and its reverse complement.
+     */
+    static const KMerDigest &Canonical(const KMerDigest &fwd, const KMerDigest &rc) {
+        return rc < fwd ? rc : fwd;
+    }
+
+    /*
+     * Digest after the k-mer drops its first nucleotide out and appends nucleotide in.
+     */
+    static void ShiftLeft(KMerDigest &d, size_t k, char out, char in) {
+        for (size_t i = 0; i < 2; ++i)
+            d.h[i] = Add(Mul(Sub(d.h[i], Mul(Value(out), Lead(i, k))), Base(i)), Value(in));
+    }
+
+    /*
+     * Digest after the k-mer drops its last nucleotide out and prepends nucleotide in.
+     */
+    static void ShiftRight(KMerDigest &d, size_t k, char out, char in) {
+        for (size_t i = 0; i < 2; ++i)
+            d.h[i] = Add(Mul(Sub(d.h[i], Value(out)), powers().inv[i]), Mul(Value(in), Lead(i, k)));
+    }
+};
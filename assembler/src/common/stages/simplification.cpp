@@ -383,8 +383,12 @@ public:
 
         AlgoStorageT algos;
 
+        size_t buff_size = simplif_cfg_.cycle_buff_size;
+        if (buff_size > 0)
+            INFO("Tip and ec candidates are checked in parallel in buffers of " << buff_size << " edges");
+
         PushValid(
-                TipClipperInstance(g_, simplif_cfg_.tc, info_container_, removal_handler_),
+                TipClipperInstance(g_, simplif_cfg_.tc, info_container_, removal_handler_, buff_size),
                 "Tip clipper",
                 algos);
         PushValid(
@@ -392,7 +396,8 @@ public:
                 "Bulge remover",
                 algos);
         PushValid(
-                ECRemoverInstance(g_, simplif_cfg_.ec, info_container_, removal_handler_, simplif_cfg_.cycle_iter_count),
+                ECRemoverInstance(g_, simplif_cfg_.ec, info_container_, removal_handler_,
+                                  simplif_cfg_.cycle_iter_count, buff_size),
                 "Low coverage edge remover",
                 algos);
 
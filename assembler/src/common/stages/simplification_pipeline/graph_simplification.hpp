@@ -341,6 +341,16 @@ protected:
         return false;
     }
 
+    bool Check(EdgeId e) const override {
+        return remove_condition_(e);
+    }
+
+    bool ProcessChecked(EdgeId e) override {
+        TRACE("Removing checked edge " << this->g().str(e));
+        edge_remover_.DeleteEdge(e);
+        return true;
+    }
+
 public:
     LowCoverageEdgeRemovingAlgorithm(Graph &g,
                                      const std::string &condition_str,
@@ -348,12 +358,14 @@ public:
                                      std::function<void(EdgeId)> removal_handler = nullptr,
                                      bool canonical_only = true,
                                      bool track_changes = true,
-                                     size_t total_iteration_estimate = -1ul)
+                                     size_t total_iteration_estimate = -1ul,
+                                     size_t buff_size = 0)
             : base(g, nullptr,
                    canonical_only,
                    omnigraph::CoverageComparator<Graph>(g),
                    track_changes,
-                   total_iteration_estimate),
+                   total_iteration_estimate,
+                   buff_size),
               simplif_info_(simplif_info),
               condition_str_(condition_str),
               edge_remover_(g, removal_handler),
@@ -528,41 +540,52 @@ AlgoPtr<Graph> ECRemoverInstance(Graph &g,
                                  const config::debruijn_config::simplification::erroneous_connections_remover &ec_config,
                                  const SimplifInfoContainer &info,
                                  EdgeRemovalHandlerF<Graph> removal_handler = nullptr,
-                                 size_t iteration_cnt = 1) {
+                                 size_t iteration_cnt = 1,
+                                 size_t buff_size = 0) {
     if (ec_config.condition.empty())
         return nullptr;
 
     return std::make_shared<LowCoverageEdgeRemovingAlgorithm<Graph>>(
             g, ec_config.condition, info, removal_handler,
-            /*canonical only*/ true, /*track changes*/ true, iteration_cnt);
+            /*canonical only*/ true, /*track changes*/ true, iteration_cnt, buff_size);
 }
 
+//Edge lengths never change, so the heap-based queue gives the same order as the set-based one
+template<class Graph>
+using LengthOrderedEdgeRemovingAlgorithm =
+        omnigraph::ParallelEdgeRemovingAlgorithm<Graph, omnigraph::LengthComparator<Graph>,
+                                                 erasable_heap_queue<typename Graph::EdgeId,
+                                                                     omnigraph::LengthComparator<Graph>>>;
+
 template<class Graph>
 AlgoPtr<Graph> TipClipperInstance(Graph &g,
                                   const EdgeConditionT<Graph> &condition,
                                   const SimplifInfoContainer &info,
                                   EdgeRemovalHandlerF<Graph> removal_handler = nullptr,
-                                  bool track_changes = true) {
-    return make_shared<omnigraph::ParallelEdgeRemovingAlgorithm<Graph, omnigraph::LengthComparator<Graph>>>(g,
+                                  bool track_changes = true,
+                                  size_t buff_size = 0) {
+    return make_shared<LengthOrderedEdgeRemovingAlgorithm<Graph>>(g,
                                                                         AddTipCondition(g, condition),
                                                                         info.chunk_cnt(),
                                                                         removal_handler,
                                                                         /*canonical_only*/true,
                                                                         LengthComparator<Graph>(g),
-                                                                        track_changes);
+                                                                        track_changes,
+                                                                        buff_size);
 }
 
 template<class Graph>
 AlgoPtr<Graph> TipClipperInstance(Graph &g,
                                   const config::debruijn_config::simplification::tip_clipper &tc_config,
                                   const SimplifInfoContainer &info,
-                                  EdgeRemovalHandlerF<Graph> removal_handler = nullptr) {
+                                  EdgeRemovalHandlerF<Graph> removal_handler = nullptr,
+                                  size_t buff_size = 0) {
     if (tc_config.condition.empty())
         return nullptr;
 
     ConditionParser<Graph> parser(g, tc_config.condition, info);
     auto condition = parser();
-    return TipClipperInstance(g, condition, info, removal_handler, /*track changes*/true);
+    return TipClipperInstance(g, condition, info, removal_handler, /*track changes*/true, buff_size);
 }
 
 template<class Graph>
@@ -575,7 +598,7 @@ AlgoPtr<Graph> DeadEndInstance(Graph &g,
 
     ConditionParser<Graph> parser(g, dead_end_config.condition, info);
     auto condition = parser();
-    return make_shared<omnigraph::ParallelEdgeRemovingAlgorithm<Graph, omnigraph::LengthComparator<Graph>>>(g,
+    return make_shared<LengthOrderedEdgeRemovingAlgorithm<Graph>>(g,
             AddDeadEndCondition(g, condition), info.chunk_cnt(), removal_handler, /*canonical_only*/true,
             LengthComparator<Graph>(g), /*track changes*/true);
 }
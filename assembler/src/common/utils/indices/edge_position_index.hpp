@@ -62,11 +62,18 @@ stream &operator<<(stream &s, const EdgeInfo<IdType> &info) {
     return s << "EdgeInfo[" << info.edge_id.int_id() << ", " << info.offset << ", " << info.count << "]";
 }
 
-template<class Graph, class StoringType = DefaultStoring>
+//Traits of the edge index of the assembly graph, see SPADES_ROLLING_KMER_HASH build option
+#ifdef SPADES_ROLLING_KMER_HASH
+typedef rolling_kmer_index_traits<RtSeq> EdgeIndexTraits;
+#else
+typedef kmer_index_traits<RtSeq> EdgeIndexTraits;
+#endif
+
+template<class Graph, class StoringType = DefaultStoring, class traits = kmer_index_traits<RtSeq>>
 class KmerFreeEdgeIndex : public KeyIteratingMap<RtSeq, EdgeInfo<typename Graph::EdgeId>,
-        kmer_index_traits<RtSeq>, StoringType> {
+        traits, StoringType> {
     typedef KeyIteratingMap<RtSeq, EdgeInfo<typename Graph::EdgeId>,
-            kmer_index_traits<RtSeq>, StoringType> base;
+            traits, StoringType> base;
     const Graph &graph_;
 
 public:
@@ -143,11 +150,11 @@ public:
     }
 };
 
-template<class Graph, class StoringType = DefaultStoring>
+template<class Graph, class StoringType = DefaultStoring, class traits = kmer_index_traits<RtSeq>>
 class KmerStoringEdgeIndex : public KeyStoringMap<RtSeq, EdgeInfo<typename Graph::EdgeId>,
-        kmer_index_traits<RtSeq>, StoringType> {
+        traits, StoringType> {
   typedef KeyStoringMap<RtSeq, EdgeInfo<typename Graph::EdgeId>,
-          kmer_index_traits<RtSeq>, StoringType> base;
+          traits, StoringType> base;
 
 public:
   typedef typename base::traits_t traits_t;
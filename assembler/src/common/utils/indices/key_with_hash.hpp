@@ -8,6 +8,14 @@
 #pragma once
 
 #include "storing_traits.hpp"
+#include "sequence/nucl.hpp"
+#include "sequence/rolling_hash.hpp"
+
+template<class traits>
+class KMerIndex;
+
+template<class Seq>
+struct rolling_kmer_index_traits;
 
 namespace debruijn_graph {
 
@@ -213,6 +221,157 @@ stream &operator<<(stream &s, const InvertableKeyWithHash<Key, Index> &kwh) {
     }
 }
 
+/*
+ * Invertable key which keeps rolling digests of itself and of its reverse complement,
+ * so that shifting it by a nucleotide updates the hash in O(1) instead of O(k).
+ * Index is looked up by the smaller of the digests, so idx() does not need to know
+ * whether the key is minimal. Requires index built with rolling_kmer_index_traits.
+ */
+template<typename Key, class HashFunction>
+class RollingKeyWithHash {
+private:
+    typedef typename HashFunction::IdxType IdxType;
+
+    const HashFunction &hash_;
+    Key key_;
+    KMerDigest digest_;
+    KMerDigest rc_digest_;
+    mutable IdxType idx_; //lazy computation
+    mutable bool ready_;
+    mutable bool is_minimal_; //lazy computation, independent of idx
+    mutable bool minimal_ready_;
+
+    void CountIdx() const {
+        ready_ = true;
+        idx_ = hash_.digest_idx(RollingHash::Canonical(digest_, rc_digest_));
+    }
+
+    static char Code(char nucl) {
+        return is_nucl(nucl) ? dignucl(nucl) : nucl;
+    }
+
+    RollingKeyWithHash(Key key, const HashFunction &hash,
+                       const KMerDigest &digest, const KMerDigest &rc_digest)
+            : hash_(hash), key_(key), digest_(digest), rc_digest_(rc_digest),
+              idx_(0), ready_(false), is_minimal_(false), minimal_ready_(false) {
+    }
+
+  public:
+
+    RollingKeyWithHash(Key key, const HashFunction &hash)
+            : hash_(hash), key_(key), idx_(0), ready_(false), is_minimal_(false), minimal_ready_(false) {
+        RollingHash::Digests(key_, digest_, rc_digest_);
+    }
+
+    RollingKeyWithHash(const RollingKeyWithHash &that)
+            : hash_(that.hash_), key_(that.key_), digest_(that.digest_), rc_digest_(that.rc_digest_),
+              idx_(that.idx_), ready_(that.ready_), is_minimal_(that.is_minimal_),
+              minimal_ready_(that.minimal_ready_) {
+    }
+
+    const Key &key() const {
+        return key_;
+    }
+
+    IdxType idx() const {
+        if (!ready_)
+            CountIdx();
+
+        return idx_;
+    }
+
+    bool is_minimal() const {
+        if(!minimal_ready_) {
+            is_minimal_ = key_.IsMinimal();
+            minimal_ready_ = true;
+        }
+        return is_minimal_;
+    }
+
+    bool ready() const {
+        return ready_;
+    }
+
+    RollingKeyWithHash &operator=(const RollingKeyWithHash &that) {
+        VERIFY(&this->hash_ == &that.hash_);
+        this->key_= that.key_;
+        this->digest_ = that.digest_;
+        this->rc_digest_ = that.rc_digest_;
+        this->idx_ = that.idx_;
+        this->ready_ = that.ready_;
+        this->is_minimal_ = that.is_minimal_;
+        this->minimal_ready_ = that.minimal_ready_;
+        return *this;
+    }
+
+    bool operator==(const RollingKeyWithHash &that) const {
+        VERIFY(&this->hash_ == &that.hash_);
+        return this->key_ == that.key_;
+    }
+
+    bool operator!=(const RollingKeyWithHash &that) const {
+        VERIFY(&this->hash_ == &that.hash_);
+        return this->key_ != that.key_;
+    }
+
+    RollingKeyWithHash operator!() const {
+        RollingKeyWithHash res(!key_, hash_, rc_digest_, digest_);
+        res.idx_ = idx_;
+        res.ready_ = ready_;
+        if (minimal_ready_) {
+            res.is_minimal_ = !is_minimal_;
+            res.minimal_ready_ = true;
+        }
+        return res;
+    }
+
+    RollingKeyWithHash operator<<(char nucl) const {
+        RollingKeyWithHash res(*this);
+        res <<= nucl;
+        return res;
+    }
+
+    RollingKeyWithHash operator>>(char nucl) const {
+        RollingKeyWithHash res(*this);
+        res >>= nucl;
+        return res;
+    }
+
+    void operator<<=(char nucl) {
+        char in = Code(nucl), out = key_[0];
+        size_t k = key_.size();
+        RollingHash::ShiftLeft(digest_, k, out, in);
+        RollingHash::ShiftRight(rc_digest_, k, char(3 - out), char(3 - in));
+        key_ <<= in;
+        ready_ = false;
+        minimal_ready_ = false;
+    }
+
+    void operator>>=(char nucl) {
+        char in = Code(nucl), out = key_[key_.size() - 1];
+        size_t k = key_.size();
+        RollingHash::ShiftRight(digest_, k, out, in);
+        RollingHash::ShiftLeft(rc_digest_, k, char(3 - out), char(3 - in));
+        key_ >>= in;
+        ready_ = false;
+        minimal_ready_ = false;
+    }
+
+    char operator[](size_t i) const {
+        return key_[i];
+    }
+};
+
+template<class stream, class Key, class Index>
+stream &operator<<(stream &s, const RollingKeyWithHash<Key, Index> &kwh) {
+    s << "RKWH[" << kwh.key();
+    if(kwh.ready()) {
+        return s << ", " << kwh.is_minimal() << ", " << kwh.idx() << "]";
+    } else {
+        return s << ", not ready]";
+    }
+}
+
 template<class K, class Index, class StoringType>
 struct StoringTraits;
 
@@ -226,4 +385,9 @@ struct StoringTraits<K, Index, InvertableStoring> {
     typedef InvertableKeyWithHash<K, Index> KeyWithHash;
 };
 
+template<class K>
+struct StoringTraits<K, KMerIndex<rolling_kmer_index_traits<K>>, InvertableStoring> {
+    typedef RollingKeyWithHash<K, KMerIndex<rolling_kmer_index_traits<K>>> KeyWithHash;
+};
+
 }
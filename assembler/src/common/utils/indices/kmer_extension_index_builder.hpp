@@ -65,14 +65,16 @@ public:
 
         // First, build a k+1-mer index
         DeBruijnReadKMerSplitter<typename Streams::ReadT,
-                                 StoringTypeFilter<typename Index::storing_type>>
+                                 StoringTypeFilter<typename Index::storing_type>,
+                                 typename Index::traits_t>
                 splitter(index.workdir(), index.k() + 1, 0xDEADBEEF, streams,
                          contigs_stream, read_buffer_size);
         KMerDiskCounter<RtSeq> counter(index.workdir(), splitter);
         counter.CountAll(nthreads, nthreads, /* merge */false);
 
         // Now, count unique k-mers from k+1-mers
-        DeBruijnKMerKMerSplitter<StoringTypeFilter<typename Index::storing_type> >
+        DeBruijnKMerKMerSplitter<StoringTypeFilter<typename Index::storing_type>,
+                                 typename Index::traits_t>
                 splitter2(index.workdir(), index.k(),
                           index.k() + 1, Index::storing_type::IsInvertable(), read_buffer_size);
         for (unsigned i = 0; i < nthreads; ++i)
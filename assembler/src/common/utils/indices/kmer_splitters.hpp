@@ -35,10 +35,11 @@ struct StoringTypeFilter<InvertableStoring> {
     }
 };
 
-using RtSeqKMerSplitter = ::KMerSortingSplitter<RtSeq>;
+template<class traits = kmer_index_traits<RtSeq>>
+using RtSeqKMerSplitter = ::KMerSortingSplitter<RtSeq, traits>;
 
-template<class KmerFilter>
-class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
+template<class KmerFilter, class traits = kmer_index_traits<RtSeq>>
+class DeBruijnKMerSplitter : public RtSeqKMerSplitter<traits> {
  private:
   KmerFilter kmer_filter_;
  protected:
@@ -65,7 +66,7 @@ class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
  public:
   DeBruijnKMerSplitter(const std::string &work_dir,
                        unsigned K, KmerFilter kmer_filter, size_t read_buffer_size = 0, uint32_t seed = 0)
-      : RtSeqKMerSplitter(work_dir, K, seed), kmer_filter_(kmer_filter), read_buffer_size_(read_buffer_size) {
+      : RtSeqKMerSplitter<traits>(work_dir, K, seed), kmer_filter_(kmer_filter), read_buffer_size_(read_buffer_size) {
   }
  protected:
   DECL_LOGGER("DeBruijnKMerSplitter");
@@ -77,8 +78,8 @@ struct ReadStatistics {
   size_t bases_;
 };
 
-template<class Read, class KmerFilter>
-class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
+template<class Read, class KmerFilter, class traits = kmer_index_traits<RtSeq>>
+class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter, traits> {
   io::ReadStreamList<Read> &streams_;
   io::SingleStream *contigs_;
 
@@ -94,7 +95,7 @@ class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
                            io::ReadStreamList<Read>& streams,
                            io::SingleStream* contigs_stream = 0,
                            size_t read_buffer_size = 0)
-      : DeBruijnKMerSplitter<KmerFilter>(work_dir, K, KmerFilter(), read_buffer_size, seed),
+      : DeBruijnKMerSplitter<KmerFilter, traits>(work_dir, K, KmerFilter(), read_buffer_size, seed),
       streams_(streams), contigs_(contigs_stream), rs_({0 ,0 ,0}) {}
 
   path::files_t Split(size_t num_files) override;
@@ -103,9 +104,9 @@ class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
   ReadStatistics stats() const { return rs_; }
 };
 
-template<class Read, class KmerFilter> template<class ReadStream>
+template<class Read, class KmerFilter, class traits> template<class ReadStream>
 ReadStatistics
-DeBruijnReadKMerSplitter<Read, KmerFilter>::FillBufferFromStream(ReadStream &stream,
+DeBruijnReadKMerSplitter<Read, KmerFilter, traits>::FillBufferFromStream(ReadStream &stream,
                                                                  unsigned thread_id) {
   typename ReadStream::ReadT r;
   size_t reads = 0, rl = 0, bases = 0;
@@ -122,8 +123,8 @@ DeBruijnReadKMerSplitter<Read, KmerFilter>::FillBufferFromStream(ReadStream &str
   return { reads, rl, bases };
 }
 
-template<class Read, class KmerFilter>
-path::files_t DeBruijnReadKMerSplitter<Read, KmerFilter>::Split(size_t num_files) {
+template<class Read, class KmerFilter, class traits>
+path::files_t DeBruijnReadKMerSplitter<Read, KmerFilter, traits>::Split(size_t num_files) {
   unsigned nthreads = (unsigned) streams_.size();
 
   INFO("Splitting kmer instances into " << num_files << " buckets. This might take a while.");
@@ -176,8 +177,8 @@ path::files_t DeBruijnReadKMerSplitter<Read, KmerFilter>::Split(size_t num_files
   return out;
 }
 
-template<class Graph, class KmerFilter>
-class DeBruijnGraphKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
+template<class Graph, class KmerFilter, class traits = kmer_index_traits<RtSeq>>
+class DeBruijnGraphKMerSplitter : public DeBruijnKMerSplitter<KmerFilter, traits> {
   typedef typename Graph::ConstEdgeIt EdgeIt;
   typedef typename Graph::EdgeId EdgeId;
 
@@ -188,14 +189,14 @@ class DeBruijnGraphKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
  public:
   DeBruijnGraphKMerSplitter(const std::string &work_dir,
                             unsigned K, const Graph &g, size_t read_buffer_size = 0)
-      : DeBruijnKMerSplitter<KmerFilter>(work_dir, K, KmerFilter(), read_buffer_size), g_(g) {}
+      : DeBruijnKMerSplitter<KmerFilter, traits>(work_dir, K, KmerFilter(), read_buffer_size), g_(g) {}
 
   path::files_t Split(size_t num_files) override;
 };
 
-template<class Graph, class KmerFilter>
+template<class Graph, class KmerFilter, class traits>
 size_t
-DeBruijnGraphKMerSplitter<Graph, KmerFilter>::FillBufferFromEdges(EdgeIt &edge,
+DeBruijnGraphKMerSplitter<Graph, KmerFilter, traits>::FillBufferFromEdges(EdgeIt &edge,
                                                                   unsigned thread_id) {
   size_t seqs = 0;
   for (; !edge.IsEnd(); ++edge) {
@@ -209,8 +210,8 @@ DeBruijnGraphKMerSplitter<Graph, KmerFilter>::FillBufferFromEdges(EdgeIt &edge,
   return seqs;
 }
 
-template<class Graph, class KmerFilter>
-path::files_t DeBruijnGraphKMerSplitter<Graph, KmerFilter>::Split(size_t num_files) {
+template<class Graph, class KmerFilter, class traits>
+path::files_t DeBruijnGraphKMerSplitter<Graph, KmerFilter, traits>::Split(size_t num_files) {
   INFO("Splitting kmer instances into " << num_files << " buckets. This might take a while.");
 
   path::files_t out = this->PrepareBuffers(num_files, 1, this->read_buffer_size_);
@@ -235,8 +236,8 @@ path::files_t DeBruijnGraphKMerSplitter<Graph, KmerFilter>::Split(size_t num_fil
 }
 
 
-template<class KmerFilter>
-class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
+template<class KmerFilter, class traits = kmer_index_traits<RtSeq>>
+class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter, traits> {
   typedef MMappedFileRecordArrayIterator<RtSeq::DataType> kmer_iterator;
 
   unsigned K_source_;
@@ -249,7 +250,7 @@ class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
  public:
   DeBruijnKMerKMerSplitter(const std::string &work_dir,
                            unsigned K_target, unsigned K_source, bool add_rc, size_t read_buffer_size = 0)
-      : DeBruijnKMerSplitter<KmerFilter>(work_dir, K_target, KmerFilter(), read_buffer_size),
+      : DeBruijnKMerSplitter<KmerFilter, traits>(work_dir, K_target, KmerFilter(), read_buffer_size),
         K_source_(K_source), add_rc_(add_rc) {}
 
   void AddKMers(const std::string &file) {
@@ -259,8 +260,8 @@ class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
   path::files_t Split(size_t num_files) override;
 };
 
-template<class KmerFilter>
-inline size_t DeBruijnKMerKMerSplitter<KmerFilter>::FillBufferFromKMers(kmer_iterator &kmer,
+template<class KmerFilter, class traits>
+inline size_t DeBruijnKMerKMerSplitter<KmerFilter, traits>::FillBufferFromKMers(kmer_iterator &kmer,
                                                                         unsigned thread_id) {
   size_t seqs = 0;
   for (; kmer.good(); ++kmer) {
@@ -278,8 +279,8 @@ inline size_t DeBruijnKMerKMerSplitter<KmerFilter>::FillBufferFromKMers(kmer_ite
   return seqs;
 }
 
-template<class KmerFilter>
-path::files_t DeBruijnKMerKMerSplitter<KmerFilter>::Split(size_t num_files) {
+template<class KmerFilter, class traits>
+path::files_t DeBruijnKMerKMerSplitter<KmerFilter, traits>::Split(size_t num_files) {
   unsigned nthreads = (unsigned) kmers_.size();
 
   INFO("Splitting kmer instances into " << num_files << " buckets. This might take a while.");
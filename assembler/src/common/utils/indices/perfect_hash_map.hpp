@@ -47,7 +47,7 @@ protected:
     }
 public:
     IndexWrapper(size_t k, const std::string &workdir)
-            : index_ptr_(std::make_shared<KMerIndexT>())
+            : index_ptr_(std::make_shared<KMerIndexT>((unsigned) k))
             , k_((unsigned) k) {
         //fixme string literal
         workdir_ = path::make_temp_dir(workdir, "kmeridx");
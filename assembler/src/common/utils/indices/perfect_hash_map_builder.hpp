@@ -83,7 +83,8 @@ size_t BuildIndexFromStream(Index &index,
                             Streams &streams,
                             io::SingleStream* contigs_stream = 0) {
     DeBruijnReadKMerSplitter<typename Streams::ReadT,
-                             StoringTypeFilter<typename Index::storing_type>>
+                             StoringTypeFilter<typename Index::storing_type>,
+                             typename Index::traits_t>
             splitter(index.workdir(), index.k(), 0, streams, contigs_stream);
     KMerDiskCounter<RtSeq> counter(index.workdir(), splitter);
     BuildIndex(index, counter, 16, streams.size());
@@ -93,7 +94,8 @@ size_t BuildIndexFromStream(Index &index,
 template<class Index, class Graph>
 void BuildIndexFromGraph(Index &index, const Graph &g, size_t read_buffer_size = 0) {
     DeBruijnGraphKMerSplitter<Graph,
-                              StoringTypeFilter<typename Index::storing_type>>
+                              StoringTypeFilter<typename Index::storing_type>,
+                              typename Index::traits_t>
             splitter(index.workdir(), index.k(), g, read_buffer_size);
     KMerDiskCounter<RtSeq> counter(index.workdir(), splitter);
     BuildIndex(index, counter, 16, 1);
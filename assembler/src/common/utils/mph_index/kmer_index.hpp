@@ -32,7 +32,7 @@ class KMerIndex {
   typedef KMerIndex __self;
 
  public:
-  KMerIndex(): index_(NULL), num_buckets_(0), size_(0) {}
+  KMerIndex(unsigned k = 0): index_(NULL), num_buckets_(0), size_(0), k_(k) {}
 
   KMerIndex(const KMerIndex&) = delete;
   KMerIndex& operator=(const KMerIndex&) = delete;
@@ -74,11 +74,20 @@ class KMerIndex {
             index_[bucket].lookup(s, typename traits::KMerSeqAdaptor());
   }
 
+  // Only for traits providing k-mer digests, e.g. rolling_kmer_index_traits
+  template<class Digest>
+  size_t digest_idx(const Digest &d) const {
+    size_t bucket = hash_function(k_)(d) % num_buckets_;
+
+    return bucket_starts_[bucket] +
+            index_[bucket].lookup(d, typename traits::KMerDigestAdaptor());
+  }
+
   size_t raw_seq_idx(const KMerRawReference data) const {
     size_t bucket = raw_seq_bucket(data);
 
     return bucket_starts_[bucket] +
-            index_[bucket].lookup(data, typename traits::KMerRawReferenceAdaptor());
+            index_[bucket].lookup(data, typename traits::KMerRawReferenceAdaptor(k_));
   }
 
   template<class Writer>
@@ -109,6 +118,7 @@ class KMerIndex {
     std::swap(num_buckets_, other.num_buckets_);
     std::swap(size_, other.size_);
     std::swap(bucket_starts_, other.bucket_starts_);
+    std::swap(k_, other.k_);
   }
 
  private:
@@ -117,12 +127,14 @@ class KMerIndex {
   size_t num_buckets_;
   std::vector<size_t> bucket_starts_;
   size_t size_;
+  //k-mer length, only needed by traits hashing raw k-mers together with their reverse complements
+  unsigned k_;
 
   size_t seq_bucket(const KMerSeq &s) const {
-    return hash_function()(s) % num_buckets_;
+    return hash_function(k_)(s) % num_buckets_;
   }
   size_t raw_seq_bucket(const KMerRawReference data) const {
-    return hash_function()(data) % num_buckets_;
+    return hash_function(k_)(data) % num_buckets_;
   }
 
   friend class KMerIndexBuilder<__self>;
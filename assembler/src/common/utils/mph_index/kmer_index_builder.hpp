@@ -73,7 +73,7 @@ class KMerSplitter {
   DECL_LOGGER("K-mer Splitting");
 };
 
-template<class Seq>
+template<class Seq, class traits = kmer_index_traits<Seq> >
 class KMerSortingSplitter : public KMerSplitter<Seq> {
  public:
   KMerSortingSplitter(const std::string &work_dir, unsigned K, uint32_t seed = 0)
@@ -186,8 +186,9 @@ class KMerSortingSplitter : public KMerSplitter<Seq> {
     return path::append_path(this->work_dir_, "kmers.raw." + std::to_string(suffix));
   }
 
+  // With zero seed must agree with KMerIndex bucketing
   unsigned GetFileNumForSeq(const Seq &s, unsigned total) const {
-    return (unsigned)(this->hash_(s, this->seed_) % total);
+    return (unsigned)(typename traits::hash_function()(s, this->seed_) % total);
   }
 
 };
@@ -457,7 +458,7 @@ size_t KMerIndexBuilder<Index>::BuildIndex(Index &index, KMerCounter<Seq> &count
     auto bucket = counter.GetBucket(iFile, !save_final);
     size_t sz = bucket->end() - bucket->begin();
     index.bucket_starts_[iFile + 1] = sz;
-    typename kmer_index_traits::KMerRawReferenceAdaptor adaptor;
+    typename kmer_index_traits::KMerRawReferenceAdaptor adaptor(index.k_);
     size_t max_nodes = (size_t(std::ceil(double(sz) * 1.23)) + 2) / 3 * 3;
     if (max_nodes >= uint64_t(1) << 32) {
         emphf::hypergraph_sorter_seq<emphf::hypergraph<uint64_t> > sorter;
@@ -6,6 +6,7 @@
 //***************************************************************************
 
 #include "io/kmers/mmapped_reader.hpp"
+#include "sequence/rolling_hash.hpp"
 #include "mphf.hpp"
 
 template<class Seq>
@@ -34,9 +35,13 @@ struct kmer_index_traits {
     }
   };
 
+  // Hash functions and adaptors are constructed with k of the index,
+  // it is needed by traits hashing k-mers together with their reverse complements
   struct hash_function {
-    uint64_t operator()(const Seq &k) const{
-      return typename Seq::hash()(k);
+    hash_function(unsigned /*k*/ = 0) {}
+
+    uint64_t operator()(const Seq &k, uint32_t seed = 0) const{
+      return typename Seq::hash()(k, seed);
     }
     uint64_t operator()(const KMerRawReference k) const {
       return typename Seq::hash()(k.data(), k.size());
@@ -44,6 +49,8 @@ struct kmer_index_traits {
   };
 
   struct KMerRawReferenceAdaptor {
+      KMerRawReferenceAdaptor(unsigned /*k*/ = 0) {}
+
       emphf::byte_range_t operator()(const KMerRawReference k) const {
           const uint8_t * data = (const uint8_t*)k.data();
           return std::make_pair(data, data + k.data_size());
@@ -90,3 +97,81 @@ struct kmer_index_traits {
   }
 
 };
+
+/*
+ * Index traits hashing k-mers by the canonical RollingHash digest, the smaller of the digests
+ * of a k-mer and of its reverse complement. Bucket hash and MPHF keys are derived from it, so
+ * RollingKeyWithHash looks k-mers up by digests updated in O(1) on each shift
+ * (see KMerIndex::digest_idx) instead of rehashing the whole k-mer.
+ */
+template<class Seq>
+struct rolling_kmer_index_traits : public kmer_index_traits<Seq> {
+  typedef kmer_index_traits<Seq> base;
+  typedef typename base::KMerRawReference KMerRawReference;
+  typedef typename base::KMerRawConstReference KMerRawConstReference;
+  typedef KMerDigest DigestType;
+
+  static DigestType digest(const Seq &k) {
+    DigestType fwd, rc;
+    RollingHash::Digests(k, fwd, rc);
+    return RollingHash::Canonical(fwd, rc);
+  }
+
+  static DigestType digest(const KMerRawReference k, unsigned K) {
+    DigestType fwd, rc;
+    RollingHash::Digests(k.data(), K, fwd, rc);
+    return RollingHash::Canonical(fwd, rc);
+  }
+
+  struct hash_function {
+    unsigned k_;
+
+    hash_function(unsigned k = 0) : k_(k) {}
+
+    uint64_t operator()(const DigestType &d, uint32_t seed = 0) const {
+      // murmur3 finalizer over the first half of the digest
+      uint64_t h = d.h[0] ^ (uint64_t(seed) * 0x9e3779b97f4a7c15ULL);
+      h ^= h >> 33;
+      h *= 0xff51afd7ed558ccdULL;
+      h ^= h >> 33;
+      h *= 0xc4ceb9fe1a85ec53ULL;
+      h ^= h >> 33;
+      return h;
+    }
+    uint64_t operator()(const Seq &k, uint32_t seed = 0) const {
+      return (*this)(digest(k), seed);
+    }
+    uint64_t operator()(const KMerRawReference k) const {
+      return (*this)(digest(k, k_));
+    }
+  };
+
+  struct KMerDigestAdaptor {
+      emphf::byte_range_t operator()(const DigestType &d) const {
+          const uint8_t * data = (const uint8_t*)d.h;
+          return std::make_pair(data, data + sizeof(d.h));
+      }
+  };
+
+  // Adaptors below keep the digest, returned byte range is valid until the next call
+  struct KMerRawReferenceAdaptor {
+      unsigned k_;
+      DigestType digest_;
+
+      KMerRawReferenceAdaptor(unsigned k = 0) : k_(k) {}
+
+      emphf::byte_range_t operator()(const KMerRawReference k) {
+          digest_ = digest(k, k_);
+          return KMerDigestAdaptor()(digest_);
+      }
+  };
+
+  struct KMerSeqAdaptor {
+      DigestType digest_;
+
+      emphf::byte_range_t operator()(const Seq &k) {
+          digest_ = digest(k);
+          return KMerDigestAdaptor()(digest_);
+      }
+  };
+};
@@ -11,6 +11,7 @@
 #include "compare_standard.hpp"
 #include "cap_kmer_index.hpp"
 #include "modules/graph_construction.hpp"
+#include "utils/openmp_wrapper.h"
 
 namespace cap {
 
@@ -159,6 +160,8 @@ class ColoredGraphConstructor {
         INFO("Determining covered ranges");
         CoveredRangesFinder<Graph, Mapper> crs_finder(g_, mapper_);
         vector<CoveredRanges> crss(streams.size());
+        //genomes are processed independently, graph and mapper are only read here
+        #pragma omp parallel for schedule(dynamic)
         for (size_t i = 0; i < streams.size(); ++i) {
             crs_finder.FindCoveredRanges(crss[i], streams[i]);
             //        DEBUG("Printing covered ranges for stream i");
@@ -190,20 +193,29 @@ class ColoredGraphConstructor {
         }
     }
 
-    void PaintGraph(ContigStream& stream, TColorSet color) {
+    vector<Path<EdgeId>> MapStream(ContigStream& stream) const {
+        vector<Path<EdgeId>> answer;
         io::SingleRead read;
         stream.reset();
         while (!stream.eof()) {
             stream >> read;
-            PaintPath(mapper_.MapSequence(read.sequence()).path(),
-                    color);
+            answer.push_back(mapper_.MapSequence(read.sequence()).path());
         }
+        return answer;
     }
 
     void PaintGraph(ContigStreams& streams, const vector<TColorSet>& stream_colors) {
         VERIFY(streams.size() == stream_colors.size());
+        //genomes are mapped in parallel, coloring is updated sequentially
+        vector<vector<Path<EdgeId>>> paths(streams.size());
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < streams.size(); ++i) {
+            paths[i] = MapStream(streams[i]);
+        }
         for (size_t i = 0; i < streams.size(); ++i) {
-            PaintGraph(streams[i], stream_colors[i]);
+            for (const auto& path : paths[i]) {
+                PaintPath(path, stream_colors[i]);
+            }
         }
     }
 
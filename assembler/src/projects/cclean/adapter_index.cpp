@@ -7,7 +7,7 @@
 
 #include "adapter_index.hpp"
 #include "io/read_processor.hpp"
-#include "valid_kmer_generator.hpp"
+#include "sequence/nucl.hpp"
 
 #include "io/ireadstream.hpp"
 #include "config_struct_cclean.hpp"
@@ -16,6 +16,39 @@
 
 using namespace cclean;
 
+// Calls f(code, pos) for every k-mer without non-ACGT symbols, where code is
+// the 2-bit encoding of the k-mer and pos is its start in the sequence.
+template<class F>
+static void ForEachKMerCode(const std::string &seq, F f) {
+  const uint64_t mask = (1ull << (2 * K)) - 1;
+  uint64_t code = 0;
+  unsigned valid = 0;
+  for (size_t i = 0; i < seq.size(); ++i) {
+    char c = seq[i];
+    if (!is_nucl(c)) {
+      valid = 0;
+      continue;
+    }
+    code = ((code << 2) | dignucl(c)) & mask;
+    if (valid < K && ++valid < K)
+      continue;
+    f(code, i + 1 - K);
+  }
+}
+
+void AdapterIndex::FindCandidates(const std::string &sequence,
+                                  IndexValueType &candidates) const {
+  const char *s = sequence.c_str();
+  ForEachKMerCode(sequence, [&](uint64_t code, size_t pos) {
+      if (!maybe_contains(code))
+        return;
+
+      auto it = index_.find(KMer(s + pos, 0, K, /* raw */ true));
+      if (it != index_.end())
+        candidates.insert(it->second.begin(), it->second.end());
+    });
+}
+
 void AdapterIndexBuilder::FillAdapterIndex(const std::string &db, AdapterIndex &data) {
   data.clear();
 
@@ -33,16 +66,10 @@ void AdapterIndexBuilder::FillAdapterIndex(const std::string &db, AdapterIndex &
   INFO("Filling adapter index");
   for (size_t i = 0, e = data.seqs_.size(); i !=e; ++i) {
     const std::string &seq = data.seqs_[i];
-    ValidKMerGenerator<cclean::K> gen(seq.c_str(), NULL, seq.size());
-
-    while (gen.HasMore()) {
-      KMer kmer = gen.kmer();
-
-      auto& entry = data.index_[kmer];
-      entry.insert(i);
-
-      gen.Next();
-    }
+    ForEachKMerCode(seq, [&](uint64_t code, size_t pos) {
+        data.mark(code);
+        data.index_[KMer(seq.c_str() + pos, 0, K, /* raw */ true)].insert(i);
+      });
   }
 
   INFO("Done. Total " << data.seqs_.size() << " adapters processed. Total "
@@ -13,7 +13,10 @@
 
 #include <string>
 #include <set>
+#include <vector>
 #include <unordered_map>
+#include <algorithm>
+#include <cstdint>
 
 namespace cclean {
 const unsigned K = 10;
@@ -24,11 +27,13 @@ class AdapterIndex {
   std::unordered_map<KMer, IndexValueType, KMer::hash> index_;
 
  public:
-  AdapterIndex() {}
+  AdapterIndex()
+      : presence_(PresenceWords, 0) {}
 
   void clear() {
     index_.clear();
     seqs_.clear();
+    std::fill(presence_.begin(), presence_.end(), 0);
   }
   IndexValueType& operator[](cclean::KMer s) { return index_[s]; }
   auto find(cclean::KMer s) const -> decltype(index_.find(s)) { return index_.find(s); }
@@ -38,9 +43,31 @@ class AdapterIndex {
     return index_.find(s) != index_.end();
   }
   const std::string& seq(size_t idx) const { return seqs_[idx]; }
+  const std::vector<std::string>& GetSeqs() const { return seqs_; }
+
+  // Cheap prefilter: false means that no adapter contains k-mer with the
+  // given 2-bit code, true means that the hash index should be consulted.
+  bool maybe_contains(uint64_t code) const {
+    return (presence_[code >> 6] >> (code & 63)) & 1;
+  }
+
+  // Collects indices of all adapters sharing a k-mer with the sequence.
+  // Most reads do not contain adapters at all, so k-mers are rolled as 2-bit
+  // codes and checked against the presence bitmap, and only the hits go to
+  // the hash index.
+  void FindCandidates(const std::string &sequence,
+                      IndexValueType &candidates) const;
 
  private:
+  // One bit per each of 4^K possible k-mers, 128Kb for K = 10
+  static const size_t PresenceWords = (1ull << (2 * K)) / 64;
+
+  void mark(uint64_t code) {
+    presence_[code >> 6] |= 1ull << (code & 63);
+  }
+
   std::vector<std::string> seqs_;
+  std::vector<uint64_t> presence_;
 
   friend class AdapterIndexBuilder;
 };
@@ -11,6 +11,10 @@
 #include "output.hpp"
 #include "config_struct_cclean.hpp"
 #include "io/read_processor.hpp"
+#include "utils/openmp_wrapper.h"
+
+#include <sstream>
+#include <vector>
 
   enum WorkModeType {
     NONE = 0,
@@ -36,9 +40,22 @@
                  score_threshold_(cfg::get().score_treshold),
                  aligned_part_fraction_(cfg::get().aligned_part_fraction),
                  db_name_(db), mode_(mode), aligned_output_stream_(aligned_output),
-                 bad_stream_(bed)  {}
+                 bad_stream_(bed), aligned_buffers_(cfg::get().nthreads),
+                 bad_buffers_(cfg::get().nthreads)  {}
       virtual Read operator()(const Read &read, bool *ok) = 0;
       inline size_t aligned() { return aligned_; }
+      // Writes debug output collected by worker threads, must be called
+      // outside of parallel region
+      void FlushReports() {
+        for (auto &buffer : aligned_buffers_) {
+          aligned_output_stream_ << buffer.str();
+          buffer.str("");
+        }
+        for (auto &buffer : bad_buffers_) {
+          bad_stream_ << buffer.str();
+          buffer.str("");
+        }
+      }
       virtual ~AbstractCclean() {}
 
     protected:
@@ -55,6 +72,16 @@
 
       std::ostream &aligned_output_stream_;
       std::ostream &bad_stream_;
+      // Per-thread debug output, so threads do not serialize on the streams
+      std::vector<std::ostringstream> aligned_buffers_;
+      std::vector<std::ostringstream> bad_buffers_;
+
+      std::ostream &aligned_report() {
+        return aligned_buffers_[omp_get_thread_num()];
+      }
+      std::ostream &bad_report() {
+        return bad_buffers_[omp_get_thread_num()];
+      }
       // Abstract for clean functors
       class AbstractCleanFunctor {
         public:
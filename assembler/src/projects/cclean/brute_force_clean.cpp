@@ -65,26 +65,24 @@ Read BruteForceClean::operator()(const Read &read, bool *ok) {
 
   if (!best_adapter.empty())  {
       aligner.Align(best_adapter.c_str(), filter, &alignment);
+#     pragma omp atomic
       aligned_ += 1;
       Read cuted_read = cclean_utils::CutRead(read, alignment.ref_begin,
                                               alignment.ref_end);
       if (full_inform_)  // If user want full output
-#       pragma omp critical
-        print_alignment(aligned_output_stream_, alignment, seq_string,
+        print_alignment(aligned_report(), alignment, seq_string,
                         best_adapter, read_name, db_name_);
 
       // Cuted read must be >= minimum lenght specified by arg
       if (cuted_read.getSequenceString().size() >= read_mlen_) {
         if (full_inform_)  // If user want full output
-#         pragma omp critical
-          print_bad(bad_stream_, read_name, alignment.ref_begin, alignment.ref_end);
+          print_bad(bad_report(), read_name, alignment.ref_begin, alignment.ref_end);
         (*ok) = true;
         return cuted_read;
       }
       else {
         if (full_inform_)
-#         pragma omp critical
-          print_bad(bad_stream_, read_name, 0, alignment.ref_end);
+          print_bad(bad_report(), read_name, 0, alignment.ref_end);
         (*ok) = false;
         return cuted_read;
       }
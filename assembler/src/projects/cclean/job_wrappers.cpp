@@ -10,8 +10,6 @@
 #include "job_wrappers.hpp"
 #include "utils/logger/log_writers.hpp"
 #include "adapter_index.hpp"
-#include "valid_kmer_generator.hpp"
-#include "adapter_index.hpp"
 #include "output.hpp"
 #include "ssw/ssw_cpp.h"
 #include "utils.hpp"
@@ -27,15 +25,11 @@ Read SimpleClean::operator()(const Read &read, bool *ok)
   const std::string& sequence = read.getSequenceString();
 
   std::set<size_t> to_check;
-  ValidKMerGenerator<cclean::K> gen(sequence.c_str(), NULL, sequence.size());
-  while (gen.HasMore()) {
-    cclean::KMer kmer = gen.kmer();
-
-    auto it = index_.find(kmer);
-    if (it != index_.end())
-      to_check.insert(it->second.begin(), it->second.end());
-
-    gen.Next();
+  index_.FindCandidates(sequence, to_check);
+  if (to_check.empty()) {
+    // No adapter shares a k-mer with the read, nothing to align
+    (*ok) = true;
+    return read;
   }
 
   //  Try to align the artifacts for corresponding kmers
@@ -65,26 +59,24 @@ Read SimpleClean::operator()(const Read &read, bool *ok)
 
   if (best_adapter != nullptr)  {
       aligner.Align(best_adapter->c_str(), filter, &alignment);
+#     pragma omp atomic
       aligned_ += 1;
       Read cuted_read = cclean_utils::CutRead(read, alignment.ref_begin,
                                               alignment.ref_end);
       if (full_inform_)  // If user want full output
-#       pragma omp critical
-        print_alignment(aligned_output_stream_, alignment, sequence,
+        print_alignment(aligned_report(), alignment, sequence,
                         *best_adapter,name, db_name_);
 
       // Cuted read must be >= minimum lenght specified by arg
       if (cuted_read.getSequenceString().size() >= read_mlen_) {
         if (full_inform_)
-#         pragma omp critical
-          print_bad(bad_stream_, name, alignment.ref_begin, alignment.ref_end);
+          print_bad(bad_report(), name, alignment.ref_begin, alignment.ref_end);
         (*ok) = true;
         return cuted_read;
       }
       else {
         if (full_inform_)
-#         pragma omp critical
-          print_bad(bad_stream_, name, 0, alignment.ref_end);
+          print_bad(bad_report(), name, 0, alignment.ref_end);
         (*ok) = false;
         return cuted_read;
       }
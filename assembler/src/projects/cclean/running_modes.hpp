@@ -40,13 +40,14 @@ class Cleaner {
                                              std::vector<Read> *reads,
                                              size_t buf_size, unsigned nthreads) {
       unsigned bad = 0;
-#     pragma omp parallel for shared(reads, results) num_threads(nthreads)
+#     pragma omp parallel for shared(reads, results) num_threads(nthreads) reduction(+:bad)
       for (size_t i = 0; i < buf_size; ++i) {
         bool ok;
         (*reads)[i] = (*cleaner)((*reads)[i], &ok);
         (*results)[i] = ok;
         if (!ok) ++bad;
       }
+      cleaner->FlushReports();
       return bad;
     }
     // Get pure file name without extension
@@ -8,6 +8,7 @@
 #include "config_struct.hpp"
 
 #include "utils/openmp_wrapper.h"
+#include "utils/logger/logger.hpp"
 
 #include "llvm/Support/YAMLParser.h"
 #include "llvm/Support/YAMLTraits.h"
@@ -51,8 +52,9 @@ struct MappingTraits<corrector::corrector_config> {
         io.mapOptional("work_dir", cfg.work_dir, std::string("."));
         io.mapOptional("output_dir", cfg.output_dir, std::string("."));
         io.mapOptional("max_nthreads", cfg.max_nthreads, 1u);
+        io.mapOptional("hard_memory_limit", cfg.hard_memory_limit, 250u);
         io.mapRequired("strategy", cfg.strat);
-        io.mapOptional("bwa", cfg.bwa, std::string("."));
+        io.mapOptional("bwa", cfg.bwa, std::string(""));
     }
 };
 }}
@@ -70,6 +72,9 @@ void load(corrector_config& cfg, const std::string &filename) {
     if (yin.error())
         throw(std::string("Failed to load config file ") + filename);
 
+    if (!cfg.bwa.empty())
+        WARN("Option bwa is deprecated and ignored, reads are aligned by the built-in BWA-MEM");
+
     // Fix number of threads according to OMP capabilities.
     cfg.max_nthreads = std::min(cfg.max_nthreads, (unsigned)omp_get_max_threads());
     // Inform OpenMP runtime about this :)
@@ -23,7 +23,10 @@ struct corrector_config {
     std::string work_dir;
     std::string output_dir;
     unsigned max_nthreads;
+    //in Gb
+    unsigned hard_memory_limit;
     Strategy strat;
+    //deprecated, reads are aligned in-process; kept to accept older configs
     std::string bwa;
 };
 
@@ -10,10 +10,7 @@
 #include "variants_table.hpp"
 
 #include "io/reads/ireader.hpp"
-#include "io/reads/osequencestream.hpp"
-#include "io/reads/file_reader.hpp"
 #include "io/reads/single_read.hpp"
-#include "utils/path_helper.hpp"
 
 #include <boost/algorithm/string.hpp>
 
@@ -21,30 +18,9 @@ using namespace std;
 
 namespace corrector {
 
-void ContigProcessor::ReadContig() {
-    io::FileReadStream frs(contig_file_);
-    io::SingleRead cur_read;
-    frs >> cur_read;
-    if (!frs.eof()) {
-#pragma omp critical
-        {
-            ERROR("Non unique sequnce in one contig fasta!");
-        }
-    }
-    contig_name_ = cur_read.name();
-    contig_ = cur_read.GetSequenceString();
-
-    output_contig_file_ = path::append_path(path::parent_path(contig_file_), path::basename(contig_file_) + ".ref.fasta");
-    charts_.resize(contig_.length());
-}
-
-void ContigProcessor::UpdateOneRead(const SingleSamRead &tmp, MappedSamStream &sm) {
+void ContigProcessor::UpdateOneRead(const ReadAlignment &tmp) {
     unordered_map<size_t, position_description> all_positions;
-    if (tmp.contig_id() < 0) {
-        return;
-    }
-    auto cur_s = sm.get_contig_name(tmp.contig_id());
-    if (contig_name_.compare(cur_s) != 0) {
+    if (tmp.contig_id < 0) {
         return;
     }
     CountPositions(tmp, all_positions);
@@ -63,6 +39,22 @@ void ContigProcessor::UpdateOneRead(const SingleSamRead &tmp, MappedSamStream &s
         error_counts_[error_num]++;
 }
 
+void ContigProcessor::FillInterestingPositions() {
+    ipp_.FillInterestingPositions(charts_);
+}
+
+void ContigProcessor::UpdateInterestingRead(const ReadAlignment &tmp) {
+    unordered_map<size_t, position_description> ps;
+    CountPositions(tmp, ps);
+    ipp_.UpdateInterestingRead(ps);
+}
+
+void ContigProcessor::UpdateInterestingRead(const ReadAlignment *left, const ReadAlignment *right) {
+    unordered_map<size_t, position_description> ps;
+    CountPositions(left, right, ps);
+    ipp_.UpdateInterestingRead(ps);
+}
+
 //returns: number of changed nucleotides;
 size_t ContigProcessor::UpdateOneBase(size_t i, stringstream &ss, const unordered_map<size_t, position_description> &interesting_positions) const{
     char old = (char) toupper(contig_[i]);
@@ -124,37 +116,35 @@ size_t ContigProcessor::UpdateOneBase(size_t i, stringstream &ss, const unordere
 }
 
 
-bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<size_t, position_description> &ps) const {
+bool ContigProcessor::CountPositions(const ReadAlignment &read, unordered_map<size_t, position_description> &ps) const {
 
-    if (read.contig_id() < 0) {
+    if (read.contig_id < 0) {
         DEBUG("not this contig");
         return false;
     }
     //TODO: maybe change to read.is_properly_aligned() ?
-    if (read.map_qual() == 0) {
+    if (read.map_qual == 0) {
         DEBUG("zero qual");
         return false;
     }
-    int pos = read.pos();
+    int pos = read.pos;
     if (pos < 0) {
-        WARN("Negative position " << pos << " found on read " << read.name() << ", skipping");
+        WARN("Negative position " << pos << " found on contig " << contig_name_ << ", skipping");
         return false;
     }
     size_t position = size_t(pos);
     int mate = 1;  // bonus for mate mapped can be here;
-    size_t l_read = (size_t) read.data_len();
-    size_t l_cigar = read.cigar_len();
+    size_t l_read = read.seq.size();
+    size_t l_cigar = read.cigar.size();
 
     int aligned_length = 0;
-    uint32_t *cigar = read.cigar_ptr();
+    const uint32_t *cigar = read.cigar.data();
     //* in cigar;
     if (l_cigar == 0)
         return false;
-    if (bam_cigar_opchr(cigar[0]) == '*')
-        return false;
     for (size_t i = 0; i < l_cigar; i++)
-        if (bam_cigar_opchr(cigar[i]) == 'M')
-            aligned_length += bam_cigar_oplen(cigar[i]);
+        if (ReadAlignment::CigarOp(cigar[i]) == 'M')
+            aligned_length += ReadAlignment::CigarOpLen(cigar[i]);
 //It's about bad aligned reads, but whether it is necessary?
     double read_len_double = (double) l_read;
     if ((aligned_length < min(read_len_double * 0.4, 40.0)) && (position > read_len_double / 2) && (contig_.length() > read_len_double / 2 + (double) position)) {
@@ -165,14 +155,14 @@ bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<si
     size_t skipped = 0;
     size_t deleted = 0;
     string insertion_string = "";
-    auto seq = read.seq_ptr();
+    const string &seq = read.seq;
     for (size_t i = 0; i < l_read; i++) {
         DEBUG(i << " " << position << " " << skipped);
-        if (shift + bam_cigar_oplen(cigar[state_pos]) <= i) {
-            shift += bam_cigar_oplen(cigar[state_pos]);
+        if (shift + ReadAlignment::CigarOpLen(cigar[state_pos]) <= i) {
+            shift += ReadAlignment::CigarOpLen(cigar[state_pos]);
             state_pos += 1;
         }
-        if (insertion_string != "" and bam_cigar_opchr(cigar[state_pos]) != 'I') {
+        if (insertion_string != "" and ReadAlignment::CigarOp(cigar[state_pos]) != 'I') {
             VERIFY(i + position >= skipped + 1);
             size_t ind = i + position - skipped - 1;
             if (ind >= contig_.length())
@@ -180,17 +170,16 @@ bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<si
             ps[ind].insertions[insertion_string] += 1;
             insertion_string = "";
         }
-        char cur_state = bam_cigar_opchr(cigar[state_pos]);
+        char cur_state = ReadAlignment::CigarOp(cigar[state_pos]);
         if (cur_state == 'M') {
             VERIFY(i >= deleted);
             if (i + position < skipped) {
                 WARN(i << " " << position << " " << skipped);
-                INFO(read.name());
             }
             VERIFY(i + position >= skipped);
 
             size_t ind = i + position - skipped;
-            size_t cur = var_to_pos[(int) bam_nt16_rev_table[bam1_seqi(seq, i - deleted)]];
+            size_t cur = var_to_pos[(int) seq[i - deleted]];
             if (ind >= contig_.length())
                 continue;
             ps[ind].votes[cur] = ps[ind].votes[cur] + mate;
@@ -204,10 +193,10 @@ bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<si
                             break;
                         ps[ind].votes[Variants::Insertion] += mate;
                     }
-                    insertion_string += bam_nt16_rev_table[bam1_seqi(seq, i - deleted)];
+                    insertion_string += seq[i - deleted];
                 }
                 skipped += 1;
-            } else if (bam_cigar_opchr(cigar[state_pos]) == 'D') {
+            } else if (ReadAlignment::CigarOp(cigar[state_pos]) == 'D') {
                 if (i + position - skipped >= contig_.length())
                     break;
                 ps[i + position - skipped].votes[Variants::Deletion] += mate;
@@ -215,7 +204,7 @@ bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<si
             }
         }
     }
-    if (insertion_string != "" and bam_cigar_opchr(cigar[state_pos]) != 'I') {
+    if (insertion_string != "" and ReadAlignment::CigarOp(cigar[state_pos]) != 'I') {
         VERIFY(l_read + position >= skipped + 1);
         size_t ind = l_read + position - skipped - 1;
         if (ind < contig_.length()) {
@@ -227,12 +216,12 @@ bool ContigProcessor::CountPositions(const SingleSamRead &read, unordered_map<si
 }
 
 
-bool ContigProcessor::CountPositions(const PairedSamRead &read, unordered_map<size_t, position_description> &ps) const {
+bool ContigProcessor::CountPositions(const ReadAlignment *left, const ReadAlignment *right, unordered_map<size_t, position_description> &ps) const {
 
     TRACE("starting pairing");
-    bool t1 = CountPositions(read.Left(), ps );
+    bool t1 = left && CountPositions(*left, ps);
     unordered_map<size_t, position_description> tmp;
-    bool t2 = CountPositions(read.Right(), tmp);
+    bool t2 = right && CountPositions(*right, tmp);
     //overlaps.. multimap? Look on qual?
     if (ps.size() == 0 || tmp.size() == 0) {
         //We do not need paired reads which are not really paired
@@ -245,37 +234,7 @@ bool ContigProcessor::CountPositions(const PairedSamRead &read, unordered_map<si
     return (t1 && t2);
 }
 
-size_t ContigProcessor::ProcessMultipleSamFiles() {
-    error_counts_.resize(kMaxErrorNum);
-    for (const auto &sf : sam_files_) {
-        MappedSamStream sm(sf.first);
-        while (!sm.eof()) {
-            SingleSamRead tmp;
-            sm >> tmp;
-
-            UpdateOneRead(tmp, sm);
-        }
-        sm.close();
-    }
-
-    ipp_.FillInterestingPositions(charts_);
-    for (const auto &sf : sam_files_) {
-        MappedSamStream sm(sf.first);
-        while (!sm.eof()) {
-            unordered_map<size_t, position_description> ps;
-            if (sf.second == io::LibraryType::PairedEnd ) {
-                PairedSamRead tmp;
-                sm >> tmp;
-                CountPositions(tmp, ps);
-            } else {
-                SingleSamRead tmp;
-                sm >> tmp;
-                CountPositions(tmp, ps);
-            }
-            ipp_.UpdateInterestingRead(ps);
-        }
-        sm.close();
-    }
+size_t ContigProcessor::CorrectContig(string &corrected_name, string &corrected) {
     ipp_.UpdateInterestingPositions();
     unordered_map<size_t, position_description> interesting_positions = ipp_.get_weights();
     stringstream s_new_contig;
@@ -285,19 +244,17 @@ size_t ContigProcessor::ProcessMultipleSamFiles() {
     }
     vector<string> contig_name_splitted;
     boost::split(contig_name_splitted, contig_name_, boost::is_any_of("_"));
-    io::osequencestream_simple oss(output_contig_file_);
     for(size_t i = 0; i < contig_name_splitted.size(); i++) {
         if (contig_name_splitted[i] == "length" && i + 1 < contig_name_splitted.size()) {
             contig_name_splitted[i + 1] = std::to_string(int(s_new_contig.str().length()));
             break;
         }
     }
-    std::string new_header = contig_name_splitted[0];
+    corrected_name = contig_name_splitted[0];
     for(size_t i = 1; i < contig_name_splitted.size(); i++) {
-        new_header += "_" + contig_name_splitted[i];
+        corrected_name += "_" + contig_name_splitted[i];
     }
-    oss.set_header(new_header);
-    oss << s_new_contig.str();
+    corrected = s_new_contig.str();
 
     return total_changes;
 }
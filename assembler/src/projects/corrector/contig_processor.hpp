@@ -15,26 +15,21 @@
 #pragma once
 #include "interesting_pos_processor.hpp"
 #include "positional_read.hpp"
+#include "read_alignment.hpp"
 #include "utils/openmp_wrapper.h"
 
-#include <io/sam/sam_reader.hpp>
-#include <io/sam/read.hpp>
-#include "pipeline/library.hpp"
-
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 namespace corrector {
 
-using namespace sam_reader;
-
-typedef std::vector<std::pair<std::string, io::LibraryType> > sam_files_type;
+// Reads are fed to the processor in two passes: the first one collects the
+// per-position statistics, the second one collects the reads covering
+// interesting positions. The reads themselves are owned by the caller, so
+// a single pass over the stored alignments can feed several contigs at once.
 class ContigProcessor {
-    sam_files_type sam_files_;
-    std::string contig_file_;
     std::string contig_name_;
-    std::string output_contig_file_;
     std::string contig_;
     std::vector<position_description> charts_;
     InterestingPositionProcessor ipp_;
@@ -43,21 +38,33 @@ class ContigProcessor {
     const size_t kMaxErrorNum = 20;
 
 public:
-    ContigProcessor(const sam_files_type &sam_files, const std::string &contig_file)
-            : sam_files_(sam_files), contig_file_(contig_file) {
-        ReadContig();
+    ContigProcessor(const std::string &contig_name, std::string contig)
+            : contig_name_(contig_name), contig_(std::move(contig)) {
+        charts_.resize(contig_.length());
         ipp_.set_contig(contig_);
+        error_counts_.resize(kMaxErrorNum);
+    }
+
+    const std::string &contig_name() const {
+        return contig_name_;
     }
-    size_t ProcessMultipleSamFiles();
+
+    //first pass
+    void UpdateOneRead(const ReadAlignment &tmp);
+    void FillInterestingPositions();
+    //second pass
+    void UpdateInterestingRead(const ReadAlignment &tmp);
+    //mates not aligned to this contig are passed as nullptr
+    void UpdateInterestingRead(const ReadAlignment *left, const ReadAlignment *right);
+    //fills the name with the updated length and the sequence of the corrected contig
+    //returns: number of changed nucleotides;
+    size_t CorrectContig(std::string &corrected_name, std::string &corrected);
 private:
-    void ReadContig();
 //Moved from read.hpp
-    bool CountPositions(const SingleSamRead &read, std::unordered_map<size_t, position_description> &ps) const;
-    bool CountPositions(const PairedSamRead &read, std::unordered_map<size_t, position_description> &ps) const;
+    bool CountPositions(const ReadAlignment &read, std::unordered_map<size_t, position_description> &ps) const;
+    bool CountPositions(const ReadAlignment *left, const ReadAlignment *right, std::unordered_map<size_t, position_description> &ps) const;
 
-    void UpdateOneRead(const SingleSamRead &tmp, MappedSamStream &sm);
     //returns: number of changed nucleotides;
-
     size_t UpdateOneBase(size_t i, std::stringstream &ss, const std::unordered_map<size_t, position_description> &interesting_positions) const ;
 
 };
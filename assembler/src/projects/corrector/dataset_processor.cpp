@@ -14,24 +14,28 @@
 #include "utils/path_helper.hpp"
 #include "io/reads/osequencestream.hpp"
 #include "utils/openmp_wrapper.h"
+#include "utils/memory_limit.hpp"
 
-#include <boost/algorithm/string.hpp>
+#include "bwa/bwa.h"
+#include "bwa/bwamem.h"
 
 #include <iostream>
+#include <memory>
+#include <cstring>
+#include <algorithm>
 #include <unistd.h>
 
 using namespace std;
 
 namespace corrector {
-std::string DatasetProcessor::GetLibDir(const size_t lib_count) {
-    if (lib_dirs_.find(lib_count) != lib_dirs_.end())
-        return lib_dirs_[lib_count];
-    std::string res = path::make_temp_dir(corr_cfg::get().work_dir, "lib" + to_string(lib_count));
-    lib_dirs_[lib_count] = res;
-    return res;
+DatasetProcessor::DatasetProcessor(const string &genome_file, const string &work_dir, const string &output_dir, const size_t &thread_num)
+        : genome_file_(genome_file), bwa_idx_(nullptr, bwa_idx_destroy), work_dir_(work_dir), nthreads_(thread_num), initial_free_memory_(0) {
+    output_contig_file_ = path::append_path(output_dir, "corrected_contigs.fasta");
 }
 
-void DatasetProcessor::SplitGenome(const string &genome_splitted_dir) {
+DatasetProcessor::~DatasetProcessor() {}
+
+void DatasetProcessor::SplitGenome(vector<string> &contig_names, vector<string> &contig_seqs) {
     io::FileReadStream frs(genome_file_);
     size_t cur_id = 0;
     while (!frs.eof()) {
@@ -42,159 +46,323 @@ void DatasetProcessor::SplitGenome(const string &genome_splitted_dir) {
         if (all_contigs_.find(contig_name) != all_contigs_.end()) {
             WARN("Duplicated contig names! Multiple contigs with name" << contig_name);
         }
-        string full_path = path::append_path(genome_splitted_dir, contig_name + ".fasta");
-        string out_full_path = path::append_path(genome_splitted_dir, contig_name + ".ref.fasta");
-        string sam_filename = path::append_path(genome_splitted_dir, contig_name + ".pair.sam");
-        all_contigs_[contig_name] = {full_path, out_full_path, contig_seq.length(), sam_files_type(), sam_filename, cur_id};
+        all_contigs_[contig_name] = {contig_seq.length(), 0, 0, cur_id};
         cur_id ++;
-        buffered_reads_[contig_name].clear();
-        io::osequencestream oss(full_path);
-        oss << io::SingleRead(contig_name, contig_seq);
-        DEBUG("full_path " + full_path)
+        contig_names.push_back(contig_name);
+        contig_seqs.push_back(contig_seq);
     }
 }
 
-//contigs - set of aligned contig names
-void DatasetProcessor::GetAlignedContigs(const string &read, set<string> &contigs) const {
-    vector<string> arr;
-    boost::split(arr, read, boost::is_any_of("\t"));
-    if (arr.size() > 5) {
-        if (arr[2] != "*" && stoi(arr[4]) > 0) {
-// here can be multuple aligned parsing if neeeded;
-            contigs.insert(arr[2]);
+void DatasetProcessor::SplitIntoShards(vector<string> &contig_seqs) {
+    vector<pair<size_t, string> > ordered_contigs;
+    for (const auto &ac : all_contigs_) {
+        ordered_contigs.push_back(make_pair(ac.second.contig_length, ac.first));
+    }
+    sort(ordered_contigs.begin(), ordered_contigs.end(), std::greater<pair<size_t, string> >());
+
+    size_t shard_num = std::max(size_t(1), std::min(ordered_contigs.size(), nthreads_ * kShardsPerThread));
+    shards_.resize(shard_num);
+    contig_shards_.resize(all_contigs_.size());
+//longest contigs go first, each one to the currently lightest shard
+    for (const auto &contig : ordered_contigs) {
+        size_t lightest = 0;
+        for (size_t i = 1; i < shard_num; ++i) {
+            if (shards_[i].total_length < shards_[lightest].total_length)
+                lightest = i;
         }
+        auto &description = all_contigs_[contig.second];
+        description.shard = lightest;
+        description.index = shards_[lightest].contig_names.size();
+        contig_shards_[description.id] = lightest;
+        shards_[lightest].contig_names.push_back(contig.second);
+        shards_[lightest].contig_seqs.push_back(std::move(contig_seqs[description.id]));
+        shards_[lightest].total_length += contig.first;
     }
+    INFO("Contigs are split into " << shard_num << " shards");
+}
 
+void DatasetProcessor::BuildContigIndex(const vector<string> &contig_names, const vector<string> &contig_seqs) {
+    bwa_idx_.reset(alignment::BuildBWAIndex(contig_names, contig_seqs));
 }
 
-void DatasetProcessor::SplitSingleLibrary(const string &all_reads_filename, const size_t lib_count) {
-    ifstream fs(all_reads_filename);
-    while (!fs.eof()) {
-        set<string> contigs;
-        string r1;
-        getline(fs, r1);
-        if (r1[0] == '@')
-            continue;
-        GetAlignedContigs(r1, contigs);
-        for (auto &contig : contigs) {
-            VERIFY_MSG(all_contigs_.find(contig) != all_contigs_.end(), "wrong contig name in SAM file header: " + contig);
-            BufferedOutputRead(r1, contig, lib_count);
-        }
+//bwa keeps the name up to the first whitespace and drops the /1, /2 mate suffix
+static string BwaReadName(const string &name) {
+    string res = name.substr(0, name.find_first_of(" \t"));
+    if (res.size() > 2 && res[res.size() - 2] == '/' && isdigit(res.back()))
+        res.resize(res.size() - 2);
+    return res;
+}
+
+namespace {
+
+struct AlignmentCollector {
+    const mem_opt_t *opt;
+    const bseq1_t *seqs;
+    vector<vector<ReadAlignment> > *alignments;
+};
+
+//Called by bwa instead of writing a SAM record; the CIGAR and the sequence are
+//clipped and oriented exactly as in the record mem_aln2sam would write.
+void CollectAlignment(void *data, const bseq1_t *s, const mem_aln_t *p, int which) {
+    const AlignmentCollector &collector = *(const AlignmentCollector *) data;
+    //such alignments are never used by contig processors
+    if (p->rid < 0 || p->n_cigar == 0 || p->mapq == 0)
+        return;
+    bool convert_clip = !(collector.opt->flag & MEM_F_SOFTCLIP) && !p->is_alt;
+    ReadAlignment a;
+    a.contig_id = p->rid;
+    a.pos = (int32_t) p->pos;
+    a.map_qual = (uint8_t) p->mapq;
+    a.primary = (which == 0);
+    a.cigar.resize(p->n_cigar);
+    for (int i = 0; i < p->n_cigar; ++i) {
+        uint32_t op = p->cigar[i] & 0xf;
+        //hard clipping for supplementary alignments
+        if (convert_clip && (op == 3 || op == 4))
+            op = which ? 4 : 3;
+        a.cigar[i] = (p->cigar[i] & ~0xfu) | op;
+    }
+    int qb = 0, qe = s->l_seq;
+    if (which && convert_clip) {
+        int first = p->cigar[0] & 0xf, last = p->cigar[p->n_cigar - 1] & 0xf;
+        int first_len = (int) (p->cigar[0] >> 4), last_len = (int) (p->cigar[p->n_cigar - 1] >> 4);
+        if (p->is_rev)
+            std::swap(first_len, last_len), std::swap(first, last);
+        if (first == 3 || first == 4)
+            qb += first_len;
+        if (last == 3 || last == 4)
+            qe -= last_len;
+    }
+    a.seq.reserve(qe - qb);
+    if (!p->is_rev) {
+        for (int i = qb; i < qe; ++i)
+            a.seq.push_back("ACGTN"[(int) s->seq[i]]);
+    } else {
+        for (int i = qe - 1; i >= qb; --i)
+            a.seq.push_back("TGCAN"[(int) s->seq[i]]);
     }
-    FlushAll(lib_count);
+    (*collector.alignments)[s - collector.seqs].push_back(a);
 }
 
-void DatasetProcessor::FlushAll(const size_t lib_count) {
-    for (const auto &ac : all_contigs_) {
-        if (buffered_reads_[ac.first].size() > 0) {
-            ofstream stream(ac.second.sam_filenames[lib_count].first.c_str(), std::ios_base::app | std::ios_base::out);
-            for (const string &read : buffered_reads_[ac.first]) {
-                stream << read;
-                stream << '\n';
-            }
-            buffered_reads_[ac.first].clear();
-        }
+}
+
+void DatasetProcessor::AlignBatch(const vector<io::SingleRead> &reads, bool paired, int64_t n_processed,
+                                  vector<vector<ReadAlignment> > &alignments) const {
+    unique_ptr<mem_opt_t, void(*)(void*)> opt(mem_opt_init(), free);
+    opt->n_threads = (int) nthreads_;
+    if (paired)
+        opt->flag |= MEM_F_PE;
+
+    vector<bseq1_t> seqs(reads.size());
+    for (size_t i = 0; i < reads.size(); ++i) {
+        seqs[i].name = strdup(BwaReadName(reads[i].name()).c_str());
+        seqs[i].seq = strdup(reads[i].GetSequenceString().c_str());
+        seqs[i].qual = strdup(reads[i].GetPhredQualityString().c_str());
+        seqs[i].l_seq = (int) reads[i].size();
+    }
+    alignments.assign(reads.size(), vector<ReadAlignment>());
+    AlignmentCollector collector = {opt.get(), seqs.data(), &alignments};
+    opt->aln_handler = CollectAlignment;
+    opt->aln_handler_data = &collector;
+    mem_process_seqs(opt.get(), bwa_idx_->bwt, bwa_idx_->bns, bwa_idx_->pac, n_processed, (int) seqs.size(), seqs.data(), nullptr);
+
+    for (auto &seq : seqs) {
+        free(seq.name);
+        free(seq.seq);
+        free(seq.qual);
+        free(seq.sam);
     }
 }
 
-void DatasetProcessor::BufferedOutputRead(const string &read, const string &contig_name, const size_t lib_count) {
-    buffered_reads_[contig_name].push_back(read);
-    buffered_count_++;
-    if (buffered_count_ % kBuffSize == 0) {
-        if (buffered_count_ % (10 * kBuffSize) == 0)
-            INFO("processed " << buffered_count_ << "reads, flushing");
-        FlushAll(lib_count);
+pair<size_t, size_t> DatasetProcessor::StoreAlignments(const vector<ReadAlignment> &alignments, const size_t lib_count) {
+    pair<size_t, size_t> primary(ShardLibrary::kNoAlignment, ShardLibrary::kNoAlignment);
+    for (const auto &a : alignments) {
+        VERIFY(size_t(a.contig_id) < contig_shards_.size());
+        size_t shard = contig_shards_[a.contig_id];
+        size_t idx = shards_[shard].libs[lib_count].alignments.Add(a);
+        if (a.primary)
+            primary = make_pair(shard, idx);
     }
+    return primary;
 }
 
-void DatasetProcessor::SplitPairedLibrary(const string &all_reads_filename, const size_t lib_count) {
-    ifstream fs(all_reads_filename);
-    while (!fs.eof()) {
-        set<string> contigs;
-        string r1;
-        string r2;
-        getline(fs, r1);
-        if (r1[0] == '@')
-            continue;
-        getline(fs, r2);
-        GetAlignedContigs(r1, contigs);
-        GetAlignedContigs(r2, contigs);
-        for (const auto &contig : contigs) {
-            VERIFY_MSG(all_contigs_.find(contig) != all_contigs_.end(), "wrong contig name in SAM file header: " + contig);
-            if (all_contigs_.find(contig) != all_contigs_.end()) {
-                BufferedOutputRead(r1, contig, lib_count);
-                BufferedOutputRead(r2, contig, lib_count);
-            }
+void DatasetProcessor::StorePairedBatch(const vector<vector<ReadAlignment> > &alignments, const size_t lib_count) {
+    const size_t kNoAlignment = ShardLibrary::kNoAlignment;
+    for (size_t i = 0; i + 1 < alignments.size(); i += 2) {
+        auto left = StoreAlignments(alignments[i], lib_count);
+        auto right = StoreAlignments(alignments[i + 1], lib_count);
+        if (left.first != kNoAlignment) {
+            size_t right_idx = (right.first == left.first ? right.second : kNoAlignment);
+            shards_[left.first].libs[lib_count].pairs.push_back(make_pair(left.second, right_idx));
+        }
+        if (right.first != kNoAlignment && right.first != left.first) {
+            shards_[right.first].libs[lib_count].pairs.push_back(make_pair(kNoAlignment, right.second));
         }
     }
-    FlushAll(lib_count);
 }
 
-string DatasetProcessor::RunPairedBwa(const string &left, const string &right, const size_t lib)  {
-    string cur_dir = GetLibDir(lib);
-    int run_res = 0;
-    string tmp_sam_filename = path::append_path(cur_dir, "tmp.sam");
-    string bwa_string = path::screen_whitespaces(path::screen_whitespaces(corr_cfg::get().bwa));
-    string genome_screened = path::screen_whitespaces(genome_file_);
-    string index_line = bwa_string + string(" index ") + "-a " + "is " + genome_screened ;
-    INFO("Running bwa index ...: " << index_line);
-    run_res = system(index_line.c_str());
-    if (run_res != 0) {
-        INFO("bwa failed, skipping sublib");
-        return "";
+void DatasetProcessor::StoreSingleBatch(const vector<vector<ReadAlignment> > &alignments, const size_t lib_count) {
+    for (const auto &read_alignments : alignments) {
+        StoreAlignments(read_alignments, lib_count);
     }
-    string nthreads_str = to_string(nthreads_);
-    string last_line = bwa_string + string(" mem ") + " -v 1 -t " + nthreads_str + " "+ genome_screened + " " + path::screen_whitespaces(left) + " " + path::screen_whitespaces(right)  + "  > "
-            + path::screen_whitespaces(tmp_sam_filename) ;
-    INFO("Running bwa mem ...:" << last_line);
-    run_res = system(last_line.c_str());
-    if (run_res != 0) {
-        INFO("bwa failed, skipping sublib");
-        return "";
+}
+
+void DatasetProcessor::AlignPairedLibrary(const string &left, const string &right, const size_t lib_count) {
+    io::FileReadStream left_stream(left), right_stream(right);
+    vector<io::SingleRead> batch;
+    vector<vector<ReadAlignment> > alignments;
+    size_t batch_length = 0;
+    int64_t n_processed = 0;
+    while (!left_stream.eof() && !right_stream.eof()) {
+        io::SingleRead r1, r2;
+        left_stream >> r1;
+        right_stream >> r2;
+        batch_length += r1.size() + r2.size();
+        batch.push_back(r1);
+        batch.push_back(r2);
+        if (batch_length >= kAlignBatchLength * nthreads_ || !(!left_stream.eof() && !right_stream.eof())) {
+            AlignBatch(batch, true, n_processed, alignments);
+            StorePairedBatch(alignments, lib_count);
+            SpillAlignmentsIfNeeded();
+            n_processed += batch.size();
+            batch.clear();
+            batch_length = 0;
+        }
     }
-    return tmp_sam_filename;
+    VERIFY_MSG(left_stream.eof() && right_stream.eof(), "different number of reads in " + left + " and " + right);
 }
 
-string DatasetProcessor::RunSingleBwa(const string &single, const size_t lib)  {
-    int run_res = 0;
-    string cur_dir = GetLibDir(lib);
-    string tmp_sam_filename = path::append_path(cur_dir, "tmp.sam");
-    string bwa_string = path::screen_whitespaces(path::screen_whitespaces(corr_cfg::get().bwa));
-    string genome_screened = path::screen_whitespaces(genome_file_);
-    string index_line = bwa_string + string(" index ") + "-a " + "is " + genome_screened ;
-    INFO("Running bwa index ...: " << index_line);
-    run_res = system(index_line.c_str());
-    if (run_res != 0) {
-        INFO("bwa failed, skipping sublib");
-        return "";
+void DatasetProcessor::AlignSingleLibrary(const string &single, const size_t lib_count) {
+    io::FileReadStream single_stream(single);
+    vector<io::SingleRead> batch;
+    vector<vector<ReadAlignment> > alignments;
+    size_t batch_length = 0;
+    int64_t n_processed = 0;
+    while (!single_stream.eof()) {
+        io::SingleRead r;
+        single_stream >> r;
+        batch_length += r.size();
+        batch.push_back(r);
+        if (batch_length >= kAlignBatchLength * nthreads_ || single_stream.eof()) {
+            AlignBatch(batch, false, n_processed, alignments);
+            StoreSingleBatch(alignments, lib_count);
+            SpillAlignmentsIfNeeded();
+            n_processed += batch.size();
+            batch.clear();
+            batch_length = 0;
+        }
     }
-    string nthreads_str = to_string(nthreads_);
-    string last_line = bwa_string + " mem "+ " -v 1 -t " + nthreads_str + " " + genome_screened + " "  + path::screen_whitespaces(single)  + "  > " + path::screen_whitespaces(tmp_sam_filename);
-    INFO("Running bwa mem ...:" << last_line);
-    run_res = system(last_line.c_str());
-    if (run_res != 0) {
-        INFO("bwa failed, skipping sublib");
-        return "";
+}
+
+void DatasetProcessor::AddLibrary(const io::LibraryType lib_type) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        auto &libs = shards_[i].libs;
+        libs.emplace_back();
+        libs.back().type = lib_type;
+        libs.back().spill_file = path::append_path(work_dir_, "shard_" + std::to_string(i) + "_lib_" + std::to_string(libs.size() - 1) + ".aln");
     }
-    return tmp_sam_filename;
 }
 
-void DatasetProcessor::PrepareContigDirs(const size_t lib_count) {
-    string out_dir = GetLibDir(lib_count);
-    for (auto &ac : all_contigs_) {
-        auto contig_name = ac.first;
-        string out_name = path::append_path(out_dir, contig_name + ".sam");
-        ac.second.sam_filenames.push_back(make_pair(out_name, unsplitted_sam_files_[lib_count].second));
-        BufferedOutputRead("@SQ\tSN:" + contig_name + "\tLN:" + to_string(all_contigs_[contig_name].contig_length), contig_name, lib_count);
+void DatasetProcessor::SpillAlignmentsIfNeeded() {
+    // Spill if the amount of free memory is less than 40% of the initial one
+    if (10 * get_free_memory() / 4 >= initial_free_memory_)
+        return;
+    size_t stored = 0;
+    for (auto &shard : shards_) {
+        for (auto &lib : shard.libs) {
+            stored += lib.alignments.data_size();
+            lib.alignments.Spill(lib.spill_file);
+        }
     }
-    FlushAll(lib_count);
+    INFO("Free memory is low, " << stored / 1024 / 1024 << " Mb of alignments moved to " << work_dir_);
+}
+
+//Alignments stored for a shard are dispatched to the processors of the contigs they are aligned to.
+//On the second pass each mate of a pair goes to the processor of its own contig. A mate aligned
+//to another contig is passed as unaligned, just like in the per-contig SAM files, whose headers
+//listed only the contig itself.
+size_t DatasetProcessor::ProcessShard(ContigShard &shard) const {
+    for (auto &lib : shard.libs) {
+        lib.alignments.Restore(lib.spill_file);
+    }
+    unordered_map<int32_t, unique_ptr<ContigProcessor> > processors;
+    for (size_t i = 0; i < shard.contig_names.size(); ++i) {
+        const auto &contig = all_contigs_.at(shard.contig_names[i]);
+        processors[int32_t(contig.id)].reset(new ContigProcessor(shard.contig_names[i], std::move(shard.contig_seqs[i])));
+    }
+    auto find_processor = [&processors](const ReadAlignment &read) -> ContigProcessor* {
+        auto it = processors.find(read.contig_id);
+        return (it == processors.end() ? nullptr : it->second.get());
+    };
+
+    ReadAlignment tmp, mate;
+    for (const auto &lib : shard.libs) {
+        for (size_t i = 0; i < lib.alignments.size(); ++i) {
+            lib.alignments.Load(i, tmp);
+            if (ContigProcessor *pc = find_processor(tmp))
+                pc->UpdateOneRead(tmp);
+        }
+    }
+
+    for (auto &pc : processors) {
+        pc.second->FillInterestingPositions();
+    }
+    for (const auto &lib : shard.libs) {
+        if (lib.type == io::LibraryType::PairedEnd) {
+            for (const auto &pair : lib.pairs) {
+                ContigProcessor *left_pc = nullptr, *right_pc = nullptr;
+                if (pair.first != ShardLibrary::kNoAlignment) {
+                    lib.alignments.Load(pair.first, tmp);
+                    left_pc = find_processor(tmp);
+                }
+                if (pair.second != ShardLibrary::kNoAlignment) {
+                    lib.alignments.Load(pair.second, mate);
+                    right_pc = find_processor(mate);
+                }
+                if (left_pc)
+                    left_pc->UpdateInterestingRead(&tmp, right_pc == left_pc ? &mate : nullptr);
+                if (right_pc && right_pc != left_pc)
+                    right_pc->UpdateInterestingRead(nullptr, &mate);
+            }
+        } else {
+            for (size_t i = 0; i < lib.alignments.size(); ++i) {
+                lib.alignments.Load(i, tmp);
+                if (ContigProcessor *pc = find_processor(tmp))
+                    pc->UpdateInterestingRead(tmp);
+            }
+        }
+    }
+
+    vector<ShardLibrary>().swap(shard.libs);
+
+    size_t total_changes = 0;
+    shard.corrected_names.resize(shard.contig_names.size());
+    for (size_t i = 0; i < shard.contig_names.size(); ++i) {
+        const auto &contig_name = shard.contig_names[i];
+        const auto &contig = all_contigs_.at(contig_name);
+        size_t changes = processors.at(int32_t(contig.id))->CorrectContig(shard.corrected_names[i], shard.contig_seqs[i]);
+        total_changes += changes;
+        if (contig.contig_length > kMinContigLengthForInfo) {
+#pragma omp critical
+            {
+                INFO("Contig " << contig_name << " processed with " << changes << " changes in thread " << omp_get_thread_num());
+            }
+        }
+    }
+    return total_changes;
 }
 
 void DatasetProcessor::ProcessDataset() {
     size_t lib_num = 0;
     INFO("Splitting assembly...");
     INFO("Assembly file: " + genome_file_);
-    SplitGenome(work_dir_);
+    vector<string> contig_names, contig_seqs;
+    SplitGenome(contig_names, contig_seqs);
+    INFO("Building BWA index for the assembly");
+    bwa_verbose = 1;
+    BuildContigIndex(contig_names, contig_seqs);
+    SplitIntoShards(contig_seqs);
+    initial_free_memory_ = get_free_memory();
     for (size_t i = 0; i < corr_cfg::get().dataset.lib_count(); ++i) {
         const auto& dataset = corr_cfg::get().dataset[i];
         auto lib_type = dataset.type();
@@ -204,70 +372,47 @@ void DatasetProcessor::ProcessDataset() {
                 string left = iter->first;
                 string right = iter->second;
                 INFO(left + " " + right);
-                string samf = RunPairedBwa(left, right, lib_num);
-                if (samf != "") {
-                    INFO("Adding samfile " << samf);
-                    unsplitted_sam_files_.push_back(make_pair(samf, lib_type));
-                    PrepareContigDirs(lib_num);
-                    SplitPairedLibrary(samf, lib_num);
-                    lib_num++;
-                } else {
-                    FATAL_ERROR("Failed to align paired reads " << left << " and " << right);
-                }
+                AddLibrary(lib_type);
+                AlignPairedLibrary(left, right, lib_num);
+                lib_num++;
             }
             for (auto iter = dataset.single_begin(); iter != dataset.single_end(); iter++) {
                 INFO("Processing single sublib of number " << lib_num);
                 string left = *iter;
                 INFO(left);
-                string samf = RunSingleBwa(left, lib_num);
-                if (samf != "") {
-                    INFO("Adding samfile " << samf);
-                    unsplitted_sam_files_.push_back(make_pair(samf, io::LibraryType::SingleReads));
-                    PrepareContigDirs(lib_num);
-                    SplitSingleLibrary(samf, lib_num);
-                    lib_num++;
-                } else {
-                    FATAL_ERROR("Failed to align single reads " << left);
-                }
+                AddLibrary(io::LibraryType::SingleReads);
+                AlignSingleLibrary(left, lib_num);
+                lib_num++;
             }
         }
     }
+    bwa_idx_.reset();
     INFO("Processing contigs");
-    vector<pair<size_t, string> > ordered_contigs;
-    for (const auto &ac : all_contigs_) {
-        ordered_contigs.push_back(make_pair(ac.second.contig_length, ac.first));
-    }
-    size_t cont_num = ordered_contigs.size();
-    sort(ordered_contigs.begin(), ordered_contigs.end(), std::greater<pair<size_t, string> >());
-    auto all_contigs_ptr = &all_contigs_;
-# pragma omp parallel for shared(all_contigs_ptr, ordered_contigs) num_threads(nthreads_) schedule(dynamic,1)
-    for (size_t i = 0; i < cont_num; i++) {
-        bool long_enough = (*all_contigs_ptr)[ordered_contigs[i].second].contig_length > kMinContigLengthForInfo;
-        ContigProcessor pc((*all_contigs_ptr)[ordered_contigs[i].second].sam_filenames, (*all_contigs_ptr)[ordered_contigs[i].second].input_contig_filename);
-        size_t changes = pc.ProcessMultipleSamFiles();
-        if (long_enough) {
-#pragma omp critical
-            {
-                INFO("Contig " << ordered_contigs[i].second << " processed with " << changes << " changes in thread " << omp_get_thread_num());
-            }
-        }
+    size_t shard_num = shards_.size();
+    size_t total_changes = 0;
+# pragma omp parallel for num_threads(nthreads_) schedule(dynamic,1) reduction(+:total_changes)
+    for (size_t i = 0; i < shard_num; i++) {
+        total_changes += ProcessShard(shards_[i]);
     }
+    INFO("Total " << total_changes << " changes made");
     INFO("Gluing processed contigs");
     GlueSplittedContigs(output_contig_file_);
 }
 
 void DatasetProcessor::GlueSplittedContigs(string &out_contigs_filename) {
-    ofstream of_c(out_contigs_filename, std::ios_base::binary);
+    io::osequencestream_simple oss(out_contigs_filename);
     vector<string> ordered_names;
     ordered_names.resize(all_contigs_.size());
     for (const auto &ac : all_contigs_) {
         ordered_names[ac.second.id] = ac.first;
     }
     for (size_t i = 0; i < ordered_names.size(); i++) {
-        ifstream a_f(all_contigs_[ordered_names[i]].output_contig_filename, std::ios_base::binary);
-        of_c << a_f.rdbuf();
+        const auto &contig = all_contigs_[ordered_names[i]];
+        const auto &shard = shards_[contig.shard];
+        oss.set_header(shard.corrected_names[contig.index]);
+        oss << shard.contig_seqs[contig.index];
     }
 }
 
 }
-;
+;
\ No newline at end of file
@@ -13,59 +13,93 @@
 #include "utils/path_helper.hpp"
 
 #include "pipeline/library.hpp"
+#include "modules/alignment/bwa_index.hpp"
+#include "read_alignment.hpp"
 
 #include <string>
-#include <set>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <limits>
 
 namespace corrector {
 
-typedef std::vector<std::pair<std:: string, io::LibraryType> > sam_files_type;
-
 struct OneContigDescription {
-    std::string input_contig_filename;
-    std::string output_contig_filename;
     size_t contig_length;
-    sam_files_type sam_filenames;
-    std::string sam_filename;
+    size_t shard;
+    //position of the contig in its shard
+    size_t index;
     size_t id;
 };
 typedef std::unordered_map<std::string, OneContigDescription> ContigInfoMap;
 
+//Alignments of a single library to the contigs of a shard.
+struct ShardLibrary {
+    static const size_t kNoAlignment = std::numeric_limits<size_t>::max();
+
+    io::LibraryType type;
+    AlignmentStorage alignments;
+    //alignments are moved there when the free memory is low
+    std::string spill_file;
+    //Paired libraries only: primary alignments of the mates, kNoAlignment if a mate is not aligned to the shard
+    std::vector<std::pair<size_t, size_t> > pairs;
+};
+
+//Contigs are grouped into shards of similar total length, alignments are stored per shard
+//(in memory or, if the free memory is low, on disk) and the shards are processed in parallel.
+struct ContigShard {
+    std::vector<std::string> contig_names;
+    //replaced by the corrected sequences when the shard is processed
+    std::vector<std::string> contig_seqs;
+    //names of the corrected contigs, with the updated length
+    std::vector<std::string> corrected_names;
+    size_t total_length;
+    std::vector<ShardLibrary> libs;
+};
+
 class DatasetProcessor {
 
     const std::string &genome_file_;
     std::string output_contig_file_;
     ContigInfoMap all_contigs_;
-    sam_files_type unsplitted_sam_files_;
+    std::vector<ContigShard> shards_;
+    //shard of each contig, indexed by contig id
+    std::vector<size_t> contig_shards_;
+    std::unique_ptr<bwaidx_t, void(*)(bwaidx_t*)> bwa_idx_;
     const std::string &work_dir_;
-    std::unordered_map<std::string, std::vector<std::string> > buffered_reads_;
     size_t nthreads_;
-    size_t buffered_count_;
-    std::unordered_map<size_t, std::string> lib_dirs_;
-    const size_t kBuffSize = 100000;
+    //free memory before the reads are aligned
+    size_t initial_free_memory_;
     const size_t kMinContigLengthForInfo = 20000;
+    const size_t kShardsPerThread = 16;
+    //total read length aligned at once, per thread
+    const size_t kAlignBatchLength = 10000000;
 public:
-    DatasetProcessor(const std::string &genome_file, const std::string &work_dir, const std::string &output_dir, const size_t &thread_num)
-            : genome_file_(genome_file), work_dir_(work_dir), nthreads_(thread_num) {
-        output_contig_file_ = path::append_path(output_dir, "corrected_contigs.fasta");
-        buffered_count_ = 0;
-    }
+    // bwaidx_t is incomplete here, therefore ctor and dtor are outlined
+    DatasetProcessor(const std::string &genome_file, const std::string &work_dir, const std::string &output_dir, const size_t &thread_num);
+    ~DatasetProcessor();
 
     void ProcessDataset();
 private:
-    void SplitGenome(const std::string &genome_splitted_dir);
-    void FlushAll(const size_t lib_count);
-    void BufferedOutputRead(const std::string &read, const std::string &contig_name, const size_t lib_count);
-    void GetAlignedContigs(const std::string &read, std::set<std::string> &contigs) const;
-    void SplitSingleLibrary(const std::string &out_contigs_filename, const size_t lib_count);
-    void SplitPairedLibrary(const std::string &all_reads, const size_t lib_count);
+    //contig_seqs[i] - sequence of the contig with id i
+    void SplitGenome(std::vector<std::string> &contig_names, std::vector<std::string> &contig_seqs);
+    //moves the sequences to the shards
+    void SplitIntoShards(std::vector<std::string> &contig_seqs);
     void GlueSplittedContigs(std::string &out_contigs_filename);
-    std::string RunPairedBwa(const std::string &left, const std::string &right, const size_t lib);
-    std::string RunSingleBwa(const std::string &single, const size_t lib);
-    void PrepareContigDirs(const size_t lib_count);
-    std::string GetLibDir(const size_t lib_count);
+    void BuildContigIndex(const std::vector<std::string> &contig_names, const std::vector<std::string> &contig_seqs);
+    //alignments[i] - alignments of reads[i]
+    void AlignBatch(const std::vector<io::SingleRead> &reads, bool paired, int64_t n_processed,
+                    std::vector<std::vector<ReadAlignment> > &alignments) const;
+    //returns: shard and index of the stored primary alignment, kNoAlignment if it is not stored
+    std::pair<size_t, size_t> StoreAlignments(const std::vector<ReadAlignment> &alignments, const size_t lib_count);
+    void StorePairedBatch(const std::vector<std::vector<ReadAlignment> > &alignments, const size_t lib_count);
+    void StoreSingleBatch(const std::vector<std::vector<ReadAlignment> > &alignments, const size_t lib_count);
+    void AlignPairedLibrary(const std::string &left, const std::string &right, const size_t lib_count);
+    void AlignSingleLibrary(const std::string &single, const size_t lib_count);
+    void AddLibrary(const io::LibraryType lib_type);
+    //moves the stored alignments to disk if the free memory dropped below a part of the initial one
+    void SpillAlignmentsIfNeeded();
+    size_t ProcessShard(ContigShard &shard) const;
 };
 }
 ;
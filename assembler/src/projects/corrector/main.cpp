@@ -11,6 +11,7 @@
 #include "utils/logger/log_writers.hpp"
 #include "config_struct.hpp"
 #include "utils/segfault_handler.hpp"
+#include "utils/memory_limit.hpp"
 
 #include "version.hpp"
 
@@ -42,6 +43,10 @@ int main(int argc, char** argv) {
         string contig_name(argv[2]);
         string cfg_file(argv[1]);
         corr_cfg::create_instance(cfg_file);
+        // hard memory limit
+        const size_t GB = 1 << 30;
+        limit_memory(corr_cfg::get().hard_memory_limit * GB);
+
         string work_dir = corr_cfg::get().work_dir;
         if (!path::check_existence(corr_cfg::get().output_dir))
             path::make_dir(corr_cfg::get().output_dir);
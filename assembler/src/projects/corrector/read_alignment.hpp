@@ -0,0 +1,149 @@
+//***************************************************************************
+//* Copyright (c) 2016 Saint Petersburg State University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/verify.hpp"
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+namespace corrector {
+
+//Alignment of a read to a contig, with the same content as a SAM record produced by bwa mem.
+struct ReadAlignment {
+    int32_t contig_id;
+    int32_t pos;
+    uint8_t map_qual;
+    //CIGAR operation is stored as length << 4 | op, op is the index of the operation in "MIDSH"
+    std::vector<uint32_t> cigar;
+    //aligned strand of the read, "ACGTN"
+    std::string seq;
+    //the first alignment reported for the read, not kept by AlignmentStorage
+    bool primary;
+
+    static char CigarOp(uint32_t c) {
+        return "MIDSH"[c & 0xf];
+    }
+
+    static uint32_t CigarOpLen(uint32_t c) {
+        return c >> 4;
+    }
+};
+
+/*
+ * Read alignments kept in memory in a compact form similar to BAM records:
+ * a fixed header, CIGAR operations and the sequence packed two nucleotides per byte.
+ * The records can be spilled to a file to free memory and restored before loading.
+ */
+class AlignmentStorage {
+    std::vector<uint8_t> data_;
+    std::vector<size_t> offsets_;
+    //size of the records in the spill file, data_ follows them
+    size_t spilled_ = 0;
+
+    template<class T>
+    void Put(const T &val) {
+        size_t pos = data_.size();
+        data_.resize(pos + sizeof(T));
+        memcpy(&data_[pos], &val, sizeof(T));
+    }
+
+    template<class T>
+    T Get(size_t &pos) const {
+        T val;
+        memcpy(&val, &data_[pos], sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    static uint8_t Code(char nucl) {
+        switch (nucl) {
+            case 'A': return 0;
+            case 'C': return 1;
+            case 'G': return 2;
+            case 'T': return 3;
+            default: return 4;
+        }
+    }
+
+public:
+    size_t size() const {
+        return offsets_.size();
+    }
+
+    //size of the records kept in memory
+    size_t data_size() const {
+        return data_.size();
+    }
+
+    //returns: index of the added alignment
+    size_t Add(const ReadAlignment &a) {
+        offsets_.push_back(spilled_ + data_.size());
+        Put(a.contig_id);
+        Put(a.pos);
+        Put(uint32_t(a.cigar.size()));
+        Put(a.map_qual);
+        Put(uint32_t(a.seq.size()));
+        for (uint32_t c : a.cigar)
+            Put(c);
+        for (size_t i = 0; i < a.seq.size(); i += 2) {
+            uint8_t packed = Code(a.seq[i]);
+            if (i + 1 < a.seq.size())
+                packed = uint8_t(packed | Code(a.seq[i + 1]) << 4);
+            data_.push_back(packed);
+        }
+        return offsets_.size() - 1;
+    }
+
+    //Appends the records kept in memory to the file and frees the memory
+    void Spill(const std::string &filename) {
+        if (data_.empty())
+            return;
+        std::ofstream os(filename, std::ios_base::binary | std::ios_base::app);
+        os.write((const char *) data_.data(), data_.size());
+        VERIFY_MSG(os.good(), "Failed to write alignments to " + filename);
+        spilled_ += data_.size();
+        std::vector<uint8_t>().swap(data_);
+    }
+
+    //Reads the spilled records back, the file is removed
+    void Restore(const std::string &filename) {
+        if (spilled_ == 0)
+            return;
+        std::vector<uint8_t> data(spilled_);
+        std::ifstream is(filename, std::ios_base::binary);
+        is.read((char *) data.data(), spilled_);
+        VERIFY_MSG(is.good(), "Failed to read alignments from " + filename);
+        is.close();
+        remove(filename.c_str());
+        data.insert(data.end(), data_.begin(), data_.end());
+        data_.swap(data);
+        spilled_ = 0;
+    }
+
+    //Unpacks the alignment into a, reusing its buffers
+    void Load(size_t idx, ReadAlignment &a) const {
+        VERIFY(spilled_ == 0);
+        VERIFY(idx < offsets_.size());
+        size_t pos = offsets_[idx];
+        a.contig_id = Get<int32_t>(pos);
+        a.pos = Get<int32_t>(pos);
+        a.cigar.resize(Get<uint32_t>(pos));
+        a.map_qual = Get<uint8_t>(pos);
+        a.seq.resize(Get<uint32_t>(pos));
+        for (auto &c : a.cigar)
+            c = Get<uint32_t>(pos);
+        for (size_t i = 0; i < a.seq.size(); ++i)
+            a.seq[i] = "ACGTN"[(data_[pos + i / 2] >> (i % 2 * 4)) & 0xf];
+    }
+};
+
+}
@@ -27,14 +27,14 @@ struct Globals {
   static double quality_lrprobs[256];
 };
 
-inline double getProb(const KMerStat &kmc, size_t i, bool log) {
-  uint8_t qual = getQual(kmc, i);
+inline double getProb(const KMerQualStat &kmq, size_t i, bool log) {
+  uint8_t qual = getQual(kmq, i);
 
   return (log ? Globals::quality_lprobs[qual] : Globals::quality_probs[qual]);
 }
 
-inline double getRevProb(const KMerStat &kmc, size_t i, bool log) {
-  uint8_t qual = getQual(kmc, i);
+inline double getRevProb(const KMerQualStat &kmq, size_t i, bool log) {
+  uint8_t qual = getQual(kmq, i);
 
   return (log ? Globals::quality_lrprobs[qual] : Globals::quality_rprobs[qual]);
 }
@@ -283,7 +283,7 @@ size_t KMerClustering::SubClusterSingle(const std::vector<size_t> & block, std::
   // Another limit: we're interested in good centers only
   size_t maxgcnt = 0;
   for (size_t i = 0; i < block.size(); ++i) {
-    float center_quality = 1 - data_[block[i]].total_qual;
+    float center_quality = 1 - data_.qual(block[i]).total_qual;
     if ((center_quality > cfg::get().bayes_singleton_threshold) ||
         (cfg::get().correct_use_threshold && center_quality > cfg::get().correct_threshold))
       maxgcnt += 1;
@@ -300,7 +300,7 @@ size_t KMerClustering::SubClusterSingle(const std::vector<size_t> & block, std::
   // Prepare the expanded k-mer structure
   std::vector<hammer::ExpandedKMer> kmers;
   for (size_t idx : block)
-    kmers.emplace_back(data_.kmer(idx), data_[idx]);
+    kmers.emplace_back(data_.kmer(idx), data_[idx], data_.qual(idx));
 
   double bestLikelihood = -std::numeric_limits<double>::infinity();
   std::vector<Center> bestCenters;
@@ -343,7 +343,7 @@ size_t KMerClustering::SubClusterSingle(const std::vector<size_t> & block, std::
         std::cout << "  " << std::setw(4) << bestCenters[k].count_ << ": ";
         if (centersInCluster[k] != -1u) {
           const KMerStat &kms = data_[block[centersInCluster[k]]];
-          std::cout << kms << " " << std::setw(8) << block[centersInCluster[k]] << "  ";
+          std::cout << kms << data_.qual(block[centersInCluster[k]]) << " " << std::setw(8) << block[centersInCluster[k]] << "  ";
         } else {
           std::cout << bestCenters[k].center_;
         }
@@ -352,8 +352,9 @@ size_t KMerClustering::SubClusterSingle(const std::vector<size_t> & block, std::
       std::cout << "The entire block:" << std::endl;
       for (uint32_t i = 0; i < origBlockSize; i++) {
         const KMerStat &kms = data_[block[i]];
-        std::cout << "  " << kms << " " << std::setw(8) << block[i] << "  ";
-        for (uint32_t j=0; j<K; ++j) std::cout << std::setw(3) << (unsigned)getQual(kms, j) << " "; std::cout << "\n";
+        const KMerQualStat &kmq = data_.qual(block[i]);
+        std::cout << "  " << kms << kmq << " " << std::setw(8) << block[i] << "  ";
+        for (uint32_t j=0; j<K; ++j) std::cout << std::setw(3) << (unsigned)getQual(kmq, j) << " "; std::cout << "\n";
       }
       std::cout << std::endl;
     }
@@ -429,9 +430,10 @@ size_t KMerClustering::SubClusterSingle(const std::vector<size_t> & block, std::
         {
           KMer newkmer(bestCenters[k].center_);
 
-          KMerStat kms(0 /* cnt */, 1.0 /* total quality */, NULL /*quality */);
+          KMerStat kms(0 /* cnt */);
           kms.mark_good();
-          new_idx = (unsigned)data_.push_back(newkmer, kms);
+          new_idx = (unsigned)data_.push_back(newkmer, kms,
+                                              KMerQualStat(1.0 /* total quality */, NULL /*quality */));
           if (data_.kmer(data_.seq_idx(newkmer)) != newkmer)
             newkmers += 1;
         }
@@ -462,18 +464,19 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
     if (cur_class.size() == 1) {
         size_t idx = cur_class[0];
         KMerStat &singl = data_[idx];
-        if ((1-singl.total_qual) > cfg::get().bayes_singleton_threshold) {
+        const KMerQualStat &singl_qual = data_.qual(idx);
+        if ((1-singl_qual.total_qual) > cfg::get().bayes_singleton_threshold) {
             singl.mark_good();
             gsingl += 1;
 
             if (ofs.good()) {
 #               pragma omp critical
                 {
-                    ofs << " good singleton: " << idx << "\n  " << singl << '\n';
+                    ofs << " good singleton: " << idx << "\n  " << singl << singl_qual << '\n';
                 }
             }
         } else {
-            if (cfg::get().correct_use_threshold && (1-singl.total_qual) > cfg::get().correct_threshold)
+            if (cfg::get().correct_use_threshold && (1-singl_qual.total_qual) > cfg::get().correct_threshold)
                 singl.mark_good();
             else
                 singl.mark_bad();
@@ -481,7 +484,7 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
             if (ofs_bad.good()) {
 #               pragma omp critical
                 {
-                    ofs_bad << " bad singleton: " << idx << "\n  " << singl << '\n';
+                    ofs_bad << " bad singleton: " << idx << "\n  " << singl << singl_qual << '\n';
                 }
             }
         }
@@ -507,13 +510,14 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
         size_t cidx = currentBlock[0];
         KMerStat &center = data_[cidx];
         KMer ckmer = data_.kmer(cidx);
-        double center_quality = 1 - center.total_qual;
+        const KMerQualStat &center_qual = data_.qual(cidx);
+        double center_quality = 1 - center_qual.total_qual;
 
         // Computing the overall quality of a cluster.
         double cluster_quality = 1;
         if (currentBlock.size() > 1) {
             for (size_t j = 1; j < currentBlock.size(); ++j)
-                cluster_quality *= data_[currentBlock[j]].total_qual;
+                cluster_quality *= data_.qual(currentBlock[j]).total_qual;
 
             cluster_quality = 1-cluster_quality;
         }
@@ -537,7 +541,7 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
 #             pragma omp critical
               {
                   ofs << " center of good cluster (" << currentBlock.size() << ", " << cluster_quality << ")" << "\n  "
-                  << center << '\n';
+                  << center << center_qual << '\n';
               }
           }
         } else {
@@ -549,7 +553,7 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
 #               pragma omp critical
                 {
                     ofs_bad << " center of bad cluster (" << currentBlock.size() << ", " << cluster_quality << ")" << "\n  "
-                            << center << '\n';
+                            << center << center_qual << '\n';
                 }
             }
         }
@@ -566,7 +570,7 @@ size_t KMerClustering::ProcessCluster(const std::vector<size_t> &cur_class,
 #               pragma omp critical
                 {
                     ofs_bad << " part of cluster (" << currentBlock.size() << ", " << cluster_quality << ")" << "\n  "
-                            << kms << '\n';
+                            << kms << data_.qual(eidx) << '\n';
                 }
             }
         }
@@ -117,10 +117,11 @@ path::files_t HammerFilteringKMerSplitter::Split(size_t num_files) {
   return out;
 }
 
-static inline void Merge(KMerStat &lhs, const KMerStat &rhs) {
-  lhs.set_count(lhs.count() + rhs.count());
-  lhs.total_qual *= rhs.total_qual;
-  lhs.qual += rhs.qual;
+static inline void Merge(KMerStat &lhs, KMerQualStat &lhs_qual,
+                         const KMerQualStat &rhs_qual) {
+  lhs.set_count(lhs.count() + 1);
+  lhs_qual.total_qual *= rhs_qual.total_qual;
+  lhs_qual.qual += rhs_qual.qual;
 }
 
 static void PushKMer(KMerData &data,
@@ -130,8 +131,8 @@ static void PushKMer(KMerData &data,
       return;
   KMerStat &kmc = data[idx];
   kmc.lock();
-  Merge(kmc,
-        KMerStat(1, (float)prob, q));
+  Merge(kmc, data.qual(idx),
+        KMerQualStat((float)prob, q));
   kmc.unlock();
 }
 
@@ -149,8 +150,8 @@ static void PushKMerRC(KMerData &data,
       return;
   KMerStat &kmc = data[idx];
   kmc.lock();
-  Merge(kmc,
-        KMerStat(1, (float)prob, rcq));
+  Merge(kmc, data.qual(idx),
+        KMerQualStat((float)prob, rcq));
   kmc.unlock();
 }
 
@@ -349,7 +350,7 @@ void KMerDataCounter::BuildKMerIndex(KMerData &data) {
 
 
   // Check, whether we'll ever have enough memory for running BH and bail out earlier
-  double needed = 1.25 * (double)kmers * (sizeof(KMerStat) + sizeof(hammer::KMer));
+  double needed = 1.25 * (double)kmers * (sizeof(KMerStat) + sizeof(KMerQualStat) + sizeof(hammer::KMer));
   if (needed > (double) get_memory_limit())
       FATAL_ERROR("The reads contain too many k-mers to fit into available memory. You need approx. "
                   << needed / 1024.0 / 1024.0 / 1024.0
@@ -380,6 +381,7 @@ void KMerDataCounter::FillKMerData(KMerData &data) {
   // Now use the index to fill the kmer quality information.
   INFO("Collecting K-mer information, this takes a while.");
   data.data_.resize(data.kmers_.size());
+  data.qual_data_.resize(data.kmers_.size());
 
   KMerDataFiller filler(data);
   const auto& dataset = cfg::get().dataset;
@@ -17,6 +17,7 @@ typedef KMerIndex<kmer_index_traits<hammer::KMer> > HammerKMerIndex;
 
 class KMerData {
   typedef std::vector<KMerStat> KMerDataStorageType;
+  typedef std::vector<KMerQualStat> KMerQualStorageType;
   typedef std::vector<hammer::KMer> KMerStorageType;
   typedef kmer_index_traits<hammer::KMer> traits;
 
@@ -34,10 +35,21 @@ class KMerData {
     kmer_push_back_buffer_.clear();
     KMerDataStorageType().swap(data_);
     KMerDataStorageType().swap(push_back_buffer_);
+    release_qualities();
   }
 
-  size_t push_back(const hammer::KMer kmer, const KMerStat &k) {
+  // Qualities are needed only for subclustering. Drop them afterwards to
+  // reduce the peak memory consumption of expansion and correction.
+  void release_qualities() {
+    KMerQualStorageType().swap(qual_data_);
+    KMerQualStorageType().swap(qual_push_back_buffer_);
+  }
+
+  bool has_qualities() const { return qual_data_.size() == data_.size() && data_.size(); }
+
+  size_t push_back(const hammer::KMer kmer, const KMerStat &k, const KMerQualStat &q) {
     push_back_buffer_.push_back(k);
+    qual_push_back_buffer_.push_back(q);
     kmer_push_back_buffer_.push_back(kmer);
 
     return data_.size() + push_back_buffer_.size() - 1;
@@ -51,6 +63,14 @@ class KMerData {
     size_t dsz = data_.size();
     return (idx < dsz ? data_[idx] : push_back_buffer_[idx - dsz]);
   }
+  KMerQualStat& qual(size_t idx) {
+    size_t dsz = qual_data_.size();
+    return (idx < dsz ? qual_data_[idx] : qual_push_back_buffer_[idx - dsz]);
+  }
+  const KMerQualStat& qual(size_t idx) const {
+    size_t dsz = qual_data_.size();
+    return (idx < dsz ? qual_data_[idx] : qual_push_back_buffer_[idx - dsz]);
+  }
   hammer::KMer kmer(size_t idx) const {
     if (idx < kmers_.size()) {
       auto it = kmers_.begin() + idx;
@@ -80,11 +100,19 @@ class KMerData {
     os.write((char*)&sz, sizeof(sz));
     os.write((char*)&data_[0], sz*sizeof(data_[0]));
 
+    sz = qual_data_.size();
+    os.write((char*)&sz, sizeof(sz));
+    os.write((char*)&qual_data_[0], sz*sizeof(qual_data_[0]));
+
     sz = push_back_buffer_.size();
     os.write((char*)&sz, sizeof(sz));
     os.write((char*)&push_back_buffer_[0], sz*sizeof(push_back_buffer_[0]));
     os.write((char*)&kmer_push_back_buffer_[0], sz*sizeof(kmer_push_back_buffer_[0]));
 
+    sz = qual_push_back_buffer_.size();
+    os.write((char*)&sz, sizeof(sz));
+    os.write((char*)&qual_push_back_buffer_[0], sz*sizeof(qual_push_back_buffer_[0]));
+
     index_.serialize(os);
     sz = kmers_.size();
     os.write((char*)&sz, sizeof(sz));
@@ -100,12 +128,20 @@ class KMerData {
     data_.resize(sz);
     is.read((char*)&data_[0], sz*sizeof(data_[0]));
 
+    is.read((char*)&sz, sizeof(sz));
+    qual_data_.resize(sz);
+    is.read((char*)&qual_data_[0], sz*sizeof(qual_data_[0]));
+
     is.read((char*)&sz, sizeof(sz));
     push_back_buffer_.resize(sz);
     is.read((char*)&push_back_buffer_[0], sz*sizeof(push_back_buffer_[0]));
     kmer_push_back_buffer_.resize(sz);
     is.read((char*)&kmer_push_back_buffer_[0], sz*sizeof(kmer_push_back_buffer_[0]));
 
+    is.read((char*)&sz, sizeof(sz));
+    qual_push_back_buffer_.resize(sz);
+    is.read((char*)&qual_push_back_buffer_[0], sz*sizeof(qual_push_back_buffer_[0]));
+
     index_.deserialize(is);
     is.read((char*)&sz, sizeof(sz));
     kmers_.set_size(sz);
@@ -119,6 +155,10 @@ class KMerData {
   KMerDataStorageType data_;
   KMerStorageType kmer_push_back_buffer_;
   KMerDataStorageType push_back_buffer_;
+  // Qualities are stored separately from the counts, so the hot data
+  // accessed during clustering and correction stays densely packed.
+  KMerQualStorageType qual_data_;
+  KMerQualStorageType qual_push_back_buffer_;
   HammerKMerIndex index_;
 
   friend class KMerDataCounter;
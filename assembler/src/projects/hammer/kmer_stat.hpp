@@ -117,21 +117,22 @@ class NibbleString {
 
 using QualBitSet = NibbleString<hammer::K, 6>;
 
+// Hot part of per-k-mer statistics: the count and "good" flag packed together
+// with the lock. This is everything clustering, expansion and correction need,
+// so it is kept separately from the (much larger) quality information.
 struct KMerStat {
-  KMerStat(uint32_t cnt, float kquality, const unsigned char *quality) : total_qual(kquality), qual(quality)  {
+  KMerStat(uint32_t cnt) {
       count_with_lock.init(0);
       set_count(cnt);
       mark_bad();
   }
-  KMerStat() : total_qual(1.0), qual() {
+  KMerStat() {
       count_with_lock.init(0);
       set_count(0);
       mark_bad();
   }
 
-  float total_qual;
   folly::PicoSpinLock<uint32_t> count_with_lock;
-  QualBitSet qual;
 
   void lock() { count_with_lock.lock(); }
   void unlock() { count_with_lock.unlock(); }
@@ -148,9 +149,27 @@ struct KMerStat {
   }
 };
 
+// Cold part of per-k-mer statistics: the qualities. These are needed only
+// during k-mer counting and subclustering and are released afterwards.
+// Updates are guarded by the lock of the corresponding KMerStat.
+struct KMerQualStat {
+  KMerQualStat(float kquality, const unsigned char *quality) : total_qual(kquality), qual(quality) {}
+  KMerQualStat() : total_qual(1.0), qual() {}
+
+  float total_qual;
+  QualBitSet qual;
+};
+
 inline
 std::ostream& operator<<(std::ostream &os, const KMerStat &kms) {
-  os << /* kms.kmer().str() << */ " (" << std::setw(3) << kms.count() << ", " << std::setprecision(6) << std::setw(8) << (1-kms.total_qual) << ')';
+  os << " (" << std::setw(3) << kms.count() << ')';
+
+  return os;
+}
+
+inline
+std::ostream& operator<<(std::ostream &os, const KMerQualStat &kmq) {
+  os << " (" << std::setprecision(6) << std::setw(8) << (1-kmq.total_qual) << ')';
 
   return os;
 }
@@ -170,23 +189,32 @@ inline void binary_read(Reader &is, QualBitSet &qbs) {
 template<class Writer>
 inline Writer& binary_write(Writer &os, const KMerStat &k) {
   os.write((char*)&k.count_with_lock, sizeof(k.count_with_lock));
-  os.write((char*)&k.total_qual, sizeof(k.total_qual));
-  return binary_write(os, k.qual);
+  return os;
 }
 
 template<class Reader>
 inline void binary_read(Reader &is, KMerStat &k) {
   is.read((char*)&k.count_with_lock, sizeof(k.count_with_lock));
+}
+
+template<class Writer>
+inline Writer& binary_write(Writer &os, const KMerQualStat &k) {
+  os.write((char*)&k.total_qual, sizeof(k.total_qual));
+  return binary_write(os, k.qual);
+}
+
+template<class Reader>
+inline void binary_read(Reader &is, KMerQualStat &k) {
   is.read((char*)&k.total_qual, sizeof(k.total_qual));
   binary_read(is, k.qual);
 }
 
-inline unsigned char getQual(const KMerStat & kmc, size_t i) {
-  return (unsigned char)kmc.qual[i];
+inline unsigned char getQual(const KMerQualStat &kmq, size_t i) {
+  return (unsigned char)kmq.qual[i];
 }
 
-inline double getProb(const KMerStat &kmc, size_t i, bool log);
-inline double getRevProb(const KMerStat &kmc, size_t i, bool log);
+inline double getProb(const KMerQualStat &kmq, size_t i, bool log);
+inline double getRevProb(const KMerQualStat &kmq, size_t i, bool log);
 
 namespace hammer {
 typedef std::array<char, hammer::K> ExpandedSeq;
@@ -204,13 +232,13 @@ static inline unsigned hamdist(const ExpandedSeq &x, const ExpandedSeq &y,
 
 class ExpandedKMer {
  public:
-  ExpandedKMer(const KMer k, const KMerStat &kmc) {
+  ExpandedKMer(const KMer k, const KMerStat &kmc, const KMerQualStat &kmq) {
     for (unsigned i = 0; i < hammer::K; ++i) {
       s_[i] = k[i];
       for (unsigned j = 0; j < 4; ++j)
         lprobs_[4*i + j] = ((char)j != s_[i] ?
-                            getRevProb(kmc, i, /* log */ true) - log(3) :
-                            getProb(kmc, i, /* log */ true));
+                            getRevProb(kmq, i, /* log */ true) - log(3) :
+                            getProb(kmq, i, /* log */ true));
     }
     count_ = kmc.count();
   }
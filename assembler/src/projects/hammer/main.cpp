@@ -117,7 +117,7 @@ int main(int argc, char * argv[]) {
     // initialize subkmer positions
     hammer::InitializeSubKMerPositions();
 
-    INFO("Size of aux. kmer data " << sizeof(KMerStat) << " bytes");
+    INFO("Size of aux. kmer data " << sizeof(KMerStat) << " + " << sizeof(KMerQualStat) << " bytes");
 
     int max_iterations = cfg::get().general_max_iterations;
 
@@ -184,6 +184,10 @@ int main(int argc, char * argv[]) {
         kmc.process(hammer::getFilename(cfg::get().input_working_dir, Globals::iteration_no, "kmers.hamming"));
         INFO("Finished clustering.");
 
+        // Qualities are not used during expansion and correction
+        if (!cfg::get().expand_write_each_iteration)
+          Globals::kmer_data->release_qualities();
+
         if (cfg::get().general_debug) {
           INFO("Debug mode on. Dumping K-mer index");
           std::string fname = hammer::getFilename(cfg::get().input_working_dir, Globals::iteration_no, "kmer.index2");
@@ -212,13 +216,13 @@ int main(int argc, char * argv[]) {
             VERIFY_MSG(rp.read() == rp.processed(), "Queue unbalanced");
           }
 
-          if (cfg::get().expand_write_each_iteration) {
+          if (cfg::get().expand_write_each_iteration && Globals::kmer_data->has_qualities()) {
             std::ofstream oftmp(hammer::getFilename(cfg::get().input_working_dir, Globals::iteration_no, "goodkmers", expand_iter_no).data());
             for (size_t n = 0; n < Globals::kmer_data->size(); ++n) {
               const KMerStat &kmer_data = (*Globals::kmer_data)[n];
               if (kmer_data.good())
                 oftmp << Globals::kmer_data->kmer(n).str() << "\n>" << n
-                      << "  cnt=" << kmer_data.count() << "  tql=" << (1-kmer_data.total_qual) << "\n";
+                      << "  cnt=" << kmer_data.count() << "  tql=" << (1-Globals::kmer_data->qual(n).total_qual) << "\n";
             }
           }
 
@@ -92,45 +92,55 @@ path::files_t HammerKMerSplitter::Split(size_t num_files) {
   return out;
 }
 
-static inline void Merge(KMerStat &lhs, const KMerStat &rhs) {
-  if (lhs.count == 0)
-    lhs.kmer = rhs.kmer;
-
-  lhs.count += rhs.count;
-  lhs.qual *= rhs.qual;
-}
-
-static void PushKMer(KMerData &data, HKMer kmer, double qual) {
-  KMerStat &kmc = data[kmer];
-  kmc.lock();
-  Merge(kmc, KMerStat(1, kmer, qual));
-  kmc.unlock();
-}
-
-static void PushKMerRC(KMerData &data, HKMer kmer, double qual) {
-  kmer = !kmer;
+// Accumulates k-mer occurrences in per-thread buffers partitioned by the index
+// range. Full buffers are applied under the lock of the corresponding range,
+// so no per-entry locking is necessary while counting.
+class KMerDataFiller {
+  struct Occurrence {
+    size_t idx;
+    HKMer kmer;
+    float qual;
+  };
+  typedef std::vector<Occurrence> OccurrenceBuffer;
 
-  KMerStat &kmc = data[kmer];
-  kmc.lock();
-  Merge(kmc, KMerStat(1, kmer, qual));
-  kmc.unlock();
-}
+  static const size_t BufferSize = 512;
 
-class KMerDataFiller {
   KMerData &data_;
+  unsigned nthreads_;
+  size_t range_size_;
+  std::vector<omp_lock_t> locks_;
+  std::vector<std::vector<OccurrenceBuffer>> buffers_;
 
  public:
-  KMerDataFiller(KMerData &data)
-      : data_(data) {}
+  KMerDataFiller(KMerData &data, unsigned nthreads)
+      : data_(data), nthreads_(nthreads), locks_(4 * nthreads), buffers_(nthreads) {
+    size_t nranges = locks_.size();
+    range_size_ = std::max<size_t>(1, (data_.size() + nranges - 1) / nranges);
+
+    for (auto &lock : locks_)
+      omp_init_lock(&lock);
+    for (auto &buffers : buffers_) {
+      buffers.resize(nranges);
+      for (auto &buffer : buffers)
+        buffer.reserve(BufferSize);
+    }
+  }
+
+  ~KMerDataFiller() {
+    for (auto &lock : locks_)
+      omp_destroy_lock(&lock);
+  }
+
+  bool operator()(std::unique_ptr<io::SingleRead> r) {
+    auto &buffers = buffers_[omp_get_thread_num()];
 
-    bool operator()(std::unique_ptr<io::SingleRead> r) const {
     ValidHKMerGenerator<hammer::K> gen(*r);
     while (gen.HasMore()) {
       HKMer kmer = gen.kmer();
-      double correct = gen.correct_probability();
+      float qual = float(1 - gen.correct_probability());
 
-      PushKMer(data_, kmer, 1 - correct);
-      PushKMerRC(data_, kmer, 1 - correct);
+      Push(buffers, kmer, qual);
+      Push(buffers, !kmer, qual);
 
       gen.Next();
     }
@@ -138,6 +148,43 @@ class KMerDataFiller {
     // Do not stop
     return false;
   }
+
+  // Apply all the pending occurrences. Each range is processed by a single
+  // thread, so no locking is required here.
+  void Flush() {
+#   pragma omp parallel for num_threads(nthreads_) schedule(dynamic)
+    for (size_t range = 0; range < locks_.size(); ++range)
+      for (auto &buffers : buffers_)
+        Apply(buffers[range]);
+  }
+
+ private:
+  void Push(std::vector<OccurrenceBuffer> &buffers, const HKMer &kmer, float qual) {
+    size_t idx = data_.seq_idx(kmer);
+    size_t range = idx / range_size_;
+
+    OccurrenceBuffer &buffer = buffers[range];
+    buffer.push_back({ idx, kmer, qual });
+    if (buffer.size() < BufferSize)
+      return;
+
+    omp_set_lock(&locks_[range]);
+    Apply(buffer);
+    omp_unset_lock(&locks_[range]);
+  }
+
+  void Apply(OccurrenceBuffer &buffer) {
+    for (const auto &occ : buffer) {
+      KMerStat &kmc = data_[occ.idx];
+      if (kmc.count() == 0)
+        kmc.kmer = occ.kmer;
+
+      kmc.set_count(kmc.count() + 1);
+      kmc.qual *= occ.qual;
+    }
+
+    buffer.clear();
+  }
 };
 
 void KMerDataCounter::FillKMerData(KMerData &data) {
@@ -153,17 +200,18 @@ void KMerDataCounter::FillKMerData(KMerData &data) {
   for (auto it = dataset.reads_begin(), et = dataset.reads_end(); it != et; ++it) {
     INFO("Processing " << *it);
     io::FileReadStream irs(*it, io::PhredOffset);
-    KMerDataFiller filler(data);
+    KMerDataFiller filler(data, cfg::get().max_nthreads);
     hammer::ReadProcessor(cfg::get().max_nthreads).Run(irs, filler);
+    filler.Flush();
   }
 
   INFO("Collection done, postprocessing.");
 
   size_t singletons = 0;
   for (size_t i = 0; i < data.size(); ++i) {
-    VERIFY(data[i].count);
+    VERIFY(data[i].count());
 
-    if (data[i].count == 1)
+    if (data[i].count() == 1)
       singletons += 1;
   }
 
@@ -11,32 +11,33 @@
 #include "utils/mph_index/kmer_index.hpp"
 #include "hkmer.hpp"
 
+#include <folly/SmallLocks.h>
+
 #include <vector>
 
 #include <cstdlib>
 
 namespace hammer {
 
+// Keep the per-k-mer entry compact: the count shares the word with the lock
+// bit and the quality is stored in single precision.
 struct KMerStat {
-  size_t count;
   HKMer kmer;
-  double qual;
+  float qual;
   unsigned changeto;
-  uint8_t lock_;
-
-  KMerStat(size_t count = 0, HKMer kmer = HKMer(), double qual = 1.0, unsigned changeto = -1)
-      : count(count), kmer(kmer), qual(qual), changeto(changeto), lock_(0) { }
+  folly::PicoSpinLock<uint32_t> count_with_lock;
 
-  void lock() {
-    while (__sync_val_compare_and_swap(&lock_, 0, 1) == 1)
-      sched_yield();
-  }
-  void unlock() {
-    lock_ = 0;
-    __sync_synchronize();
+  KMerStat(uint32_t count = 0, HKMer kmer = HKMer(), float qual = 1.0, unsigned changeto = -1)
+      : kmer(kmer), qual(qual), changeto(changeto) {
+    count_with_lock.init(count);
   }
+
+  void lock() { count_with_lock.lock(); }
+  void unlock() { count_with_lock.unlock(); }
+  uint32_t count() const { return count_with_lock.getData(); }
+  void set_count(uint32_t cnt) { count_with_lock.setData(cnt); }
 };
-  
+
 };
 
 typedef KMerIndex<kmer_index_traits<hammer::HKMer> > HammerKMerIndex;
@@ -105,7 +106,7 @@ struct CountCmp {
       : kmer_data_(kmer_data) {}
 
   bool operator()(unsigned lhs, unsigned rhs) {
-    return kmer_data_[lhs].count > kmer_data_[rhs].count;
+    return kmer_data_[lhs].count() > kmer_data_[rhs].count();
   }
 };
 
@@ -152,19 +152,17 @@ int main(int argc, char** argv) {
       size_t nonread = 0;
 #if 1
       INFO("Subclustering.");
-#     pragma omp parallel for shared(nonread, classes, kmer_data)
+#     pragma omp parallel for shared(classes, kmer_data) reduction(+:nonread)
       for (size_t i = 0; i < classes.size(); ++i) {
         auto& cluster = classes[i];
 
-#       pragma omp atomic
         nonread += subcluster(kmer_data, cluster);
       }
 #else
       INFO("Assigning centers");
-#     pragma omp parallel for shared(nonread, classes, kmer_data)
+#     pragma omp parallel for shared(classes, kmer_data) reduction(+:nonread)
       for (size_t i = 0; i < classes.size(); ++i) {
         const auto& cluster = classes[i];
-#       pragma omp atomic
         nonread += assign(kmer_data, cluster);
       }
 #endif
@@ -211,7 +209,7 @@ int main(int argc, char** argv) {
       size_t idx = kmer_data.seq_idx(c);
       if (kmer_data[idx].kmer == c) {
         fasta_ofs << '>' << std::setw(6) << i
-                  << "-cov_" << std::setw(0) << kmer_data[idx].count
+                  << "-cov_" << std::setw(0) << kmer_data[idx].count()
                   << "-qual_" << 1.0 - kmer_data[idx].qual;
 
         if (cluster.size() == 1)
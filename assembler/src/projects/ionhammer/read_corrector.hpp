@@ -343,7 +343,7 @@ class HKMerProlonger {
         for (size_t len = 1; len <= 4; ++len) {
           kmer[changing_pos] = hammer::HomopolymerRun(nucl, len);
           auto &k = kmer_data_[kmer];
-          auto qual = k.count * (1 - k.qual);
+          auto qual = k.count() * (1 - k.qual);
           if (qual > best_qual) {
             next_best_qual = best_qual;
             best_qual = qual;
@@ -820,7 +820,7 @@ class CorrectedRead {
       auto k = kmer_data_[center.seq];
 
       for (size_t i = 0; i < hammer::K; ++i)
-        scores[chunk_pos + i](center.seq[i].nucl, center.seq[i].len) += double(k.count) * (1.0 - k.qual);
+        scores[chunk_pos + i](center.seq[i].nucl, center.seq[i].len) += double(k.count()) * (1.0 - k.qual);
 
       last_good_center = center;
       last_good_center_is_defined = true;
@@ -924,13 +924,13 @@ class CorrectedRead {
         if (debug_mode_ && !low_qual && seq != center.seq) {
           std::cerr << "replaced " << seq.str()
                     << " (quality " << kmer_data_[seq].qual
-                    << ", count " << kmer_data_[seq].count << ")"
+                    << ", count " << kmer_data_[seq].count() << ")"
                     << " with " << center.seq.str() << std::endl;
         }
 
         if (debug_mode_) {
           std::cerr << "quality of " << center.seq.str() << " is " << qual
-                    << " (count " << kmer_data_[center.seq].count << ") "
+                    << " (count " << kmer_data_[center.seq].count() << ") "
                     << (inconsistent ? " INCONSISTENT" : "") << std::endl;
         }
 
@@ -27,11 +27,11 @@ hammer::HKMer center(const KMerData &data, const std::vector<size_t>& kmers) {
       const hammer::KMerStat &k = data[kmers[j]];
       // FIXME: switch to MLE when we'll have use per-run quality values
 #if 1
-      scores(k.kmer[i].nucl, k.kmer[i].len) += double(k.count) * (1 - k.qual);
+      scores(k.kmer[i].nucl, k.kmer[i].len) += double(k.count()) * (1 - k.qual);
 #else
       for (unsigned n = 0; n < 4; ++n)
         for (unsigned l = 1; l < 64; ++l)
-          scores(n, l) += k.count * (n == k.kmer[i].nucl && l == k.kmer[i].len ?
+          scores(n, l) += k.count() * (n == k.kmer[i].nucl && l == k.kmer[i].len ?
                                      log(1 - k.qual) : log(k.qual) - log(4*63 - 1));
 #endif
     }
@@ -66,7 +66,7 @@ void dump(const KMerData &kmer_data, const std::vector<size_t> &cluster) {
   for (size_t j = 0; j < cluster.size(); ++j) {
     if (j > 0) std::cerr << ", ";
     std::cerr << '"' << kmer_data[cluster[j]].kmer << "\": ["
-              << kmer_data[cluster[j]].count << ", " 
+              << kmer_data[cluster[j]].count() << ", " 
               << 1 - kmer_data[cluster[j]].qual << "] \n";
   }
   std::cerr << "}, \"center\": { \"status\": ";
@@ -1,5 +1,6 @@
 #include "contig_abundance.hpp"
 #include "utils/indices/kmer_splitters.hpp"
+#include "utils/openmp_wrapper.h"
 
 namespace debruijn_graph {
 
@@ -13,17 +14,16 @@ size_t SampleCount() {
     return sample_cnt_;
 }
 
-MplVector SingleClusterAnalyzer::SampleMpls(const KmerProfiles& kmer_mpls, size_t sample) const {
-    MplVector answer;
+void SingleClusterAnalyzer::SampleMpls(const KmerProfiles& kmer_mpls, size_t sample, MplVector& answer) const {
+    answer.clear();
     answer.reserve(kmer_mpls.size());
     for (const auto& kmer_mpl : kmer_mpls) {
         answer.push_back(kmer_mpl[sample]);
     }
-    return answer;
 }
 
-Mpl SingleClusterAnalyzer::SampleMedian(const KmerProfiles& kmer_mpls, size_t sample) const {
-    std::vector<Mpl> sample_mpls = SampleMpls(kmer_mpls, sample);
+Mpl SingleClusterAnalyzer::SampleMedian(const KmerProfiles& kmer_mpls, size_t sample, MplVector& sample_mpls) const {
+    SampleMpls(kmer_mpls, sample, sample_mpls);
 
     std::nth_element(sample_mpls.begin(), sample_mpls.begin() + sample_mpls.size()/2, sample_mpls.end());
     return sample_mpls[sample_mpls.size()/2];
@@ -32,8 +32,9 @@ Mpl SingleClusterAnalyzer::SampleMedian(const KmerProfiles& kmer_mpls, size_t sa
 MplVector SingleClusterAnalyzer::MedianVector(const KmerProfiles& kmer_mpls) const {
     VERIFY(kmer_mpls.size() != 0);
     MplVector answer(SampleCount(), 0);
+    MplVector sample_mpls;
     for (size_t i = 0; i < SampleCount(); ++i) {
-        answer[i] = SampleMedian(kmer_mpls, i);
+        answer[i] = SampleMedian(kmer_mpls, i, sample_mpls);
     }
     return answer;
 }
@@ -125,17 +126,20 @@ void ContigAbundanceCounter::Init(const std::string& file_prefix) {
     std::ifstream kmers_in(file_prefix + ".kmm", std::ios::binary);
     kmer_mpl_.BinRead(kmers_in, file_prefix + ".kmm");
 
-    INFO("Loading kmer profiles data");
+    INFO("Mapping kmer profiles data");
     const size_t data_size = SampleCount() * kmer_mpl_.size();
-    mpl_data_.resize(data_size);
-    std::ifstream mpls_in(file_prefix + ".bpr", std::ios::binary);
-    mpls_in.read((char *)&mpl_data_[0], data_size * sizeof(Mpl));
+    mpl_data_.reset(new MMappedRecordReader<Mpl>(file_prefix + ".bpr", /*unlink*/false, -1ULL));
+    VERIFY_MSG(mpl_data_->size() == data_size, "Profiles file " << file_prefix << ".bpr"
+               << " contains " << mpl_data_->size() << " values instead of " << data_size);
+
+    profile_buffers_.resize(omp_get_max_threads());
 }
 
 boost::optional<AbundanceVector> ContigAbundanceCounter::operator()(
         const std::string& s,
         const std::string& /*name*/) const {
-    KmerProfiles kmer_mpls;
+    KmerProfiles& kmer_mpls = profile_buffers_[omp_get_thread_num()];
+    kmer_mpls.clear();
 
     for (const auto& seq : SplitOnNs(s)) {
         if (seq.size() < k_)
@@ -149,7 +153,7 @@ boost::optional<AbundanceVector> ContigAbundanceCounter::operator()(
             TRACE("Processing kmer " << kwh.key().str());
             if (kmer_mpl_.valid(kwh)) {
                 TRACE("Valid");
-                KmerProfile prof(&mpl_data_[kmer_mpl_.get_value(kwh, inverter_)]);
+                KmerProfile prof(mpl_data_->data() + kmer_mpl_.get_value(kwh, inverter_));
                 kmer_mpls.push_back(prof);
                 //if (!name.empty()) {
                 //    os << PrintVector(kmer_mpl_.get_value(kwh, inverter_), sample_cnt_) << std::endl;
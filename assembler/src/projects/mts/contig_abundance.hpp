@@ -2,6 +2,7 @@
 
 #include "pipeline/graph_pack.hpp"
 #include "utils/indices/perfect_hash_map_builder.hpp"
+#include "io/kmers/mmapped_reader.hpp"
 
 namespace debruijn_graph {
 
@@ -83,8 +84,8 @@ class SingleClusterAnalyzer {
     double coord_vise_proximity_;
     double central_clust_share_;
 
-    MplVector SampleMpls(const KmerProfiles& kmer_mpls, size_t sample) const;
-    Mpl SampleMedian(const KmerProfiles& kmer_mpls, size_t sample) const;
+    void SampleMpls(const KmerProfiles& kmer_mpls, size_t sample, MplVector& answer) const;
+    Mpl SampleMedian(const KmerProfiles& kmer_mpls, size_t sample, MplVector& sample_mpls) const;
     MplVector MedianVector(const KmerProfiles& kmer_mpls) const;
     bool AreClose(const KmerProfile& c, const KmerProfile& v) const;
     KmerProfiles CloseKmerMpls(const KmerProfiles& kmer_mpls, const KmerProfile& center) const;
@@ -115,7 +116,10 @@ class ContigAbundanceCounter {
     double min_earmark_share_;
     IndexT kmer_mpl_;
     InverterT inverter_;
-    std::vector<Mpl> mpl_data_;
+    //profiles matrix is mapped (read-only) to be shared between the processes
+    std::unique_ptr<MMappedRecordReader<Mpl>> mpl_data_;
+    //per-thread scratch buffers
+    mutable std::vector<KmerProfiles> profile_buffers_;
 
     void FillMplMap(const std::string& kmers_mpl_file);
 
@@ -134,6 +138,7 @@ public:
 
     void Init(const std::string& kmer_mpl_file);
 
+    //thread-safe after Init
     boost::optional<AbundanceVector> operator()(const std::string& s, const std::string& /*name*/ = "") const;
 
 private:
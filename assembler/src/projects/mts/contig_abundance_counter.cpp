@@ -8,18 +8,20 @@
 #include "logger.hpp"
 #include "formats.hpp"
 #include "contig_abundance.hpp"
+#include "utils/openmp_wrapper.h"
 
 using namespace debruijn_graph;
 
 //Helper class to have scoped DEBUG()
 class Runner {
-public:
-    static void Run(ContigAbundanceCounter& abundance_counter, size_t min_length_bound,
-                    io::FileReadStream& contigs_stream, io::osequencestream& splits_os,
-                    std::ofstream& id_out, std::ofstream& mpl_out) {
-        static const size_t split_length = 10000;
+    static const size_t split_length = 10000;
+    static const size_t batch_size = 10000;
+
+    static void ReadBatch(size_t min_length_bound, io::FileReadStream& contigs_stream,
+                          io::osequencestream& splits_os, std::vector<io::SingleRead>& batch) {
+        batch.clear();
         io::SingleRead full_contig;
-        while (!contigs_stream.eof()) {
+        while (batch.size() < batch_size && !contigs_stream.eof()) {
             contigs_stream >> full_contig;
             DEBUG("Analyzing contig " << GetId(full_contig));
 
@@ -31,12 +33,30 @@ public:
 
                 io::SingleRead contig = full_contig.Substr(i, std::min(i + split_length, full_contig.size()));
                 splits_os << contig;
+                DEBUG("Processing fragment # " << (i / split_length) << " with id " << GetId(contig));
+                batch.push_back(contig);
+            }
+        }
+    }
 
-                contig_id id = GetId(contig);
-                DEBUG("Processing fragment # " << (i / split_length) << " with id " << id);
+public:
+    static void Run(ContigAbundanceCounter& abundance_counter, size_t min_length_bound,
+                    io::FileReadStream& contigs_stream, io::osequencestream& splits_os,
+                    std::ofstream& id_out, std::ofstream& mpl_out) {
+        std::vector<io::SingleRead> batch;
+        std::vector<boost::optional<AbundanceVector>> abundances;
+        while (!contigs_stream.eof()) {
+            ReadBatch(min_length_bound, contigs_stream, splits_os, batch);
 
-                auto abundance_vec = abundance_counter(contig.GetSequenceString(), contig.name());
+            abundances.assign(batch.size(), boost::none);
+            #pragma omp parallel for schedule(dynamic)
+            for (size_t i = 0; i < batch.size(); ++i) {
+                abundances[i] = abundance_counter(batch[i].GetSequenceString(), batch[i].name());
+            }
 
+            for (size_t i = 0; i < batch.size(); ++i) {
+                contig_id id = GetId(batch[i]);
+                const auto& abundance_vec = abundances[i];
                 if (abundance_vec) {
                     stringstream ss;
                     copy(abundance_vec->begin(), abundance_vec->end(),
@@ -59,7 +79,7 @@ int main(int argc, char** argv) {
     using namespace GetOpt;
 
     unsigned k;
-    size_t sample_cnt, min_length_bound;
+    size_t sample_cnt, min_length_bound, nthreads;
     std::string work_dir, contigs_path, splits_path;
     std::string kmer_mult_fn, contigs_abundance_fn;
 
@@ -73,17 +93,20 @@ int main(int argc, char** argv) {
             >> Option('n', sample_cnt)
             >> Option('m', kmer_mult_fn)
             >> Option('o', contigs_abundance_fn)
-            >> Option('l', min_length_bound, size_t(0));
+            >> Option('l', min_length_bound, size_t(0))
+            >> Option('t', "threads", nthreads, size_t(1));
     } catch(GetOptEx &ex) {
         std::cout << "Usage: contig_abundance_counter -k <K> -w <work_dir> -c <contigs path> "
                 "-n <sample cnt> -m <kmer multiplicities path> -f <splits_path> "
-                "-o <contigs abundance path> [-l <contig length bound> (default: 0)]"  << std::endl;
+                "-o <contigs abundance path> [-l <contig length bound> (default: 0)] "
+                "[-t <threads> (default: 1)]"  << std::endl;
         exit(1);
     }
 
     //TmpFolderFixture fixture("tmp");
     create_console_logger();
 
+    omp_set_num_threads((int) nthreads);
     SetSampleCount(sample_cnt);
     ContigAbundanceCounter abundance_counter(k, SingleClusterAnalyzer(), work_dir);
     abundance_counter.Init(kmer_mult_fn);
@@ -10,10 +10,11 @@
 #include <boost/optional/optional.hpp>
 #include "getopt_pp/getopt_pp.h"
 #include "kmc_api/kmc_file.h"
-//#include "omp.h"
+#include "adt/loser_tree.hpp"
 #include "io/kmers/mmapped_reader.hpp"
 #include "utils/path_helper.hpp"
 #include "utils/simple_tools.hpp"
+#include "utils/openmp_wrapper.h"
 #include "utils/indices/perfect_hash_map_builder.hpp"
 #include "utils/indices/kmer_splitters.hpp"
 #include "logger.hpp"
@@ -24,11 +25,95 @@ using std::vector;
 const string KMER_PARSED_EXTENSION = ".bin";
 const string KMER_SORTED_EXTENSION = ".sorted";
 
+struct KmerCount {
+    RtSeq kmer;
+    uint32 count;
+    uint32 sample;
+};
+
+//the order of sorted k-mer dumps
+struct KmerCountLess {
+    bool operator()(const KmerCount& l, const KmerCount& r) const {
+        return RtSeq::less3()(l.kmer, r.kmer);
+    }
+};
+
+//Reads sorted k-mer dump of a sample by blocks
+class SortedKmerStream {
+    size_t k_;
+    uint32 sample_;
+    std::ifstream input_;
+    std::vector<KmerCount> buffer_;
+    size_t pos_;
+    bool eof_;
+
+    bool ReadKmerWithCount(KmerCount& res) {
+        RtSeq seq(k_);
+        if (!seq.BinRead(input_)) {
+            return false;
+        }
+        seq_element_type tmp;
+        input_.read((char*) &tmp, sizeof(seq_element_type));
+        res = {seq, (uint32) tmp, sample_};
+        return true;
+    }
+
+public:
+    SortedKmerStream(size_t k, uint32 sample, const string& filename) :
+        k_(k), sample_(sample), input_(filename, std::ios::binary), pos_(0), eof_(false) {
+        VERIFY_MSG(input_.good(), "Failed to open " << filename);
+    }
+
+    //keeps not yet consumed k-mers and reads the next ones up to block_size
+    void Refill(size_t block_size) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + pos_);
+        pos_ = 0;
+        KmerCount next = {RtSeq(k_), 0, sample_};
+        while (!eof_ && buffer_.size() < block_size) {
+            if (!ReadKmerWithCount(next)) {
+                eof_ = true;
+                break;
+            }
+            buffer_.push_back(next);
+        }
+    }
+
+    bool eof() const {
+        return eof_;
+    }
+
+    bool empty() const {
+        return pos_ == buffer_.size();
+    }
+
+    const RtSeq& back() const {
+        return buffer_.back().kmer;
+    }
+
+    //k-mers not exceeding the bound
+    adt::iterator_range<std::vector<KmerCount>::const_iterator> TakeUpTo(const KmerCount& bound) {
+        auto begin = buffer_.cbegin() + pos_;
+        auto end = std::upper_bound(begin, buffer_.cend(), bound, KmerCountLess());
+        pos_ = end - buffer_.cbegin();
+        return adt::make_range(begin, end);
+    }
+
+    adt::iterator_range<std::vector<KmerCount>::const_iterator> TakeAll() {
+        auto begin = buffer_.cbegin() + pos_;
+        pos_ = buffer_.size();
+        return adt::make_range(begin, buffer_.cend());
+    }
+};
+
 class KmerMultiplicityCounter {
 
     size_t k_, sample_cnt_;
     std::string file_prefix_;
 
+    //total number of k-mers buffered for all samples
+    static const size_t kTotalBufferKmers = 1 << 22;
+    static const size_t kMinBlockKmers = 1 << 10;
+
     //TODO: get rid of intermediate .bin file
     string ParseKmc(const string& filename) {
         CKMCFile kmcFile;
@@ -58,77 +143,97 @@ class KmerMultiplicityCounter {
         return sorted_filename;
     }
 
-    bool ReadKmerWithCount(std::ifstream& infile, std::pair<RtSeq, uint32>& res) {
-        RtSeq seq(res.first.size());
-        if (!seq.BinRead(infile)) {
-            return false;
+    void WriteKmer(const RtSeq& kmer, const std::vector<uint32>& cnt_vector,
+                   std::ofstream& output_kmer, std::ofstream& output_cnt) {
+        kmer.BinWrite(output_kmer);
+        string delim = "";
+        for (auto cnt : cnt_vector) {
+            output_cnt << delim << cnt;
+            delim = " ";
         }
-        seq_element_type tmp;
-        infile.read((char*) &tmp, sizeof(seq_element_type));
-        res = {seq, (uint32) tmp};
-        return true;
+        output_cnt << std::endl;
     }
 
-    void FilterCombinedKmers(const std::vector<string>& files, size_t all_min) {
+    //KMC does not list a database in a globally sorted order (it goes bin by bin),
+    //so every sample is dumped and sorted first, in parallel across samples.
+    //Sorted dumps are then read by blocks and merged, every round merges all k-mers not exceeding
+    //the smallest last buffered k-mer among unfinished samples, so no k-mer spans two rounds.
+    void FilterCombinedKmers(const std::vector<string>& files, size_t all_min, size_t nthreads) {
         size_t n = files.size();
-        vector<std::unique_ptr<ifstream>> infiles;
-        infiles.reserve(n);
-        for (auto fn : files) {
-            INFO("Processing " << fn);
-            auto parsed = ParseKmc(fn);
-            auto sorted = SortKmersCountFile(parsed);
-            infiles.emplace_back(new std::ifstream(sorted));
+        VERIFY(n > 0);
+        std::vector<string> sorted_files(n);
+        #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+        for (size_t i = 0; i < n; ++i) {
+            #pragma omp critical
+            {
+                INFO("Processing " << files[i]);
+            }
+            sorted_files[i] = SortKmersCountFile(ParseKmc(files[i]));
         }
-        vector<std::pair<RtSeq, uint32>> top_kmer(n, {RtSeq(k_), 0});
-        vector<bool> alive(n, false);
 
-        for (size_t i = 0; i < n; i++) {
-            alive[i] = ReadKmerWithCount(*infiles[i], top_kmer[i]);
+        std::vector<std::unique_ptr<SortedKmerStream>> streams;
+        streams.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            streams.emplace_back(new SortedKmerStream(k_, (uint32) i, sorted_files[i]));
         }
+        size_t block_size = std::max(kMinBlockKmers, kTotalBufferKmers / n);
 
         std::ofstream output_kmer(file_prefix_ + ".kmer", std::ios::binary);
         std::ofstream output_cnt(file_prefix_ + ".mpl");
 
-        RtSeq::less3 kmer_less;
+        typedef std::vector<KmerCount>::const_iterator It;
+        std::vector<uint32> cnt_vector(n, 0);
+        size_t total = 0, written = 0;
         while (true) {
-            boost::optional<RtSeq> min_kmer;
-            size_t cnt_min = 0;
+            #pragma omp parallel for num_threads(nthreads) schedule(dynamic)
             for (size_t i = 0; i < n; ++i) {
-                if (alive[i]) {
-                    RtSeq& cur_kmer = top_kmer[i].first;
-                    if (!min_kmer || kmer_less(cur_kmer, *min_kmer)) {
-                        min_kmer = cur_kmer;
-                        cnt_min = 0;
-                    }
-                    if (cur_kmer == *min_kmer) {
-                        cnt_min++;
-                    }
+                streams[i]->Refill(block_size);
+            }
+
+            boost::optional<KmerCount> bound;
+            bool finished = true;
+            for (const auto& stream : streams) {
+                if (!stream->eof()) {
+                    finished = false;
+                    if (!bound || RtSeq::less3()(stream->back(), bound->kmer))
+                        bound = KmerCount{stream->back(), 0, 0};
                 }
             }
-            if (!min_kmer) {
-                break;
+
+            std::vector<adt::iterator_range<It>> runs;
+            runs.reserve(n);
+            for (const auto& stream : streams) {
+                runs.push_back(bound ? stream->TakeUpTo(*bound) : stream->TakeAll());
             }
-            if (cnt_min >= all_min) {
-                std::vector<uint32> cnt_vector(n, 0);
-                min_kmer.get().BinWrite(output_kmer);
-                for (size_t i = 0; i < n; ++i) {
-                    if (alive[i] && top_kmer[i].first == *min_kmer) {
-                        cnt_vector[i] += top_kmer[i].second;
+
+            adt::loser_tree<It, KmerCountLess> tree(runs);
+            boost::optional<RtSeq> current;
+            size_t cnt_samples = 0;
+            while (!tree.empty()) {
+                KmerCount next = tree.pop();
+                total += 1;
+                if (current && *current != next.kmer) {
+                    if (cnt_samples >= all_min) {
+                        WriteKmer(*current, cnt_vector, output_kmer, output_cnt);
+                        written += 1;
                     }
+                    std::fill(cnt_vector.begin(), cnt_vector.end(), 0);
+                    cnt_samples = 0;
                 }
-                string delim = "";
-                for (auto cnt : cnt_vector) {
-                    output_cnt << delim << cnt;
-                    delim = " ";
-                }
-                output_cnt << std::endl;
+                current = next.kmer;
+                cnt_vector[next.sample] += next.count;
+                cnt_samples += 1;
             }
-            for (size_t i = 0; i < n; ++i) {
-                if (alive[i] && top_kmer[i].first == *min_kmer) {
-                    alive[i] = ReadKmerWithCount(*infiles[i], top_kmer[i]);
-                }
+            if (current && cnt_samples >= all_min) {
+                WriteKmer(*current, cnt_vector, output_kmer, output_cnt);
+                written += 1;
             }
+            std::fill(cnt_vector.begin(), cnt_vector.end(), 0);
+
+            if (finished)
+                break;
         }
+        INFO("Merged " << total << " k-mer records, " << written << " k-mers are present in at least " << all_min << " samples");
     }
 
     void BuildKmerIndex(size_t sample_cnt, const std::string& workdir, size_t nthreads) {
@@ -205,7 +310,7 @@ public:
     }
 
     void CombineMultiplicities(const vector<string>& input_files, size_t min_samples, const string& work_dir, size_t nthreads = 1) {
-        FilterCombinedKmers(input_files, min_samples);
+        FilterCombinedKmers(input_files, min_samples, nthreads);
         BuildKmerIndex(input_files.size(), work_dir, nthreads);
     }
 private:
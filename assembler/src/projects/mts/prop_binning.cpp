@@ -9,6 +9,7 @@
 #include "io/reads/io_helper.hpp"
 #include "io/reads/osequencestream.hpp"
 #include "pipeline/graphio.hpp"
+#include "utils/openmp_wrapper.h"
 #include "logger.hpp"
 #include "read_binning.hpp"
 #include "propagate.hpp"
@@ -52,7 +53,8 @@ int main(int argc, char** argv) {
     vector<string> sample_names, left_reads, right_reads;
     string out_root, propagation_dump;
     vector<bin_id> bins_of_interest;
-    bool no_binning;
+    bool no_binning, gzip_output;
+    size_t nthreads;
     try {
         GetOpt_pp ops(argc, argv);
         ops.exceptions_all();
@@ -67,11 +69,14 @@ int main(int argc, char** argv) {
             >> Option('o', out_root)
             >> Option('d', propagation_dump, "")
             >> Option('b', bins_of_interest, {})
+            >> Option('t', "threads", nthreads, size_t(1))
+            >> OptionPresent('z', gzip_output)
             >> OptionPresent('p', no_binning);
     } catch(GetOptEx &ex) {
         cout << "Usage: prop_binning -k <K> -s <saves path> -c <contigs path> -f <splits path> "
                 "-a <binning annotation> -n <sample names> -l <left reads> -r <right reads> -o <output root> "
-                "[-d <propagation info dump>] [-p to disable binning] [-b <bins of interest>*]"  << endl;
+                "[-d <propagation info dump>] [-p to disable binning] [-b <bins of interest>*] "
+                "[-t <threads> (default: 1)] [-z to gzip binned reads]"  << endl;
         exit(1);
     }
 
@@ -79,6 +84,7 @@ int main(int argc, char** argv) {
         VERIFY_MSG(bin_id.find_last_of(',') == std::string::npos, "Specify bins of interest via space, not comma");
     }
 
+    omp_set_num_threads((int) nthreads);
     conj_graph_pack gp(k, "tmp", 1);
     gp.kmer_mapper.Attach();
 
@@ -116,7 +122,7 @@ int main(int argc, char** argv) {
 //    INFO("Using propagated annotation from " << propagated_path);
 //    AnnotationStream binning_stream(propagated_path);
     for (size_t i = 0; i < sample_names.size(); ++i) {
-        ContigBinner binner(gp, edge_annotation, out_root, sample_names[i]);
+        ContigBinner binner(gp, edge_annotation, out_root, sample_names[i], gzip_output);
         INFO("Initializing binner for " << sample_names[i]);
         auto paired_stream = io::PairedEasyStream(left_reads[i], right_reads[i], false, 0);
         INFO("Running binner on " << left_reads[i] << " and " << right_reads[i]);
@@ -10,6 +10,7 @@
 
 #include "pipeline/graphio.hpp"
 #include "io/reads/file_reader.hpp"
+#include "utils/openmp_wrapper.h"
 #include "read_binning.hpp"
 
 namespace debruijn_graph {
@@ -21,23 +22,59 @@ set<bin_id> ContigBinner::RelevantBins(const io::SingleRead& r) const {
 void ContigBinner::Init(bin_id bin) {
     string out_dir = out_root_ + "/" + ToString(bin) + "/";
     path::make_dirs(out_dir);
-    out_streams_.insert(make_pair(bin, make_shared<io::OPairedReadStream>(out_dir + sample_name_ + "_1.fastq",
-                                                                          out_dir + sample_name_ + "_2.fastq")));
+    string ext = gzip_ ? ".fastq.gz" : ".fastq";
+    out_streams_.insert(make_pair(bin, make_shared<io::OPairedReadStream>(out_dir + sample_name_ + "_1" + ext,
+                                                                          out_dir + sample_name_ + "_2" + ext,
+                                                                          gzip_)));
+}
+
+void ContigBinner::Flush() {
+    for (auto& buffers : thread_buffers_) {
+        for (auto& bin_buffer : buffers) {
+            BinBuffer& buffer = bin_buffer.second;
+            if (buffer.left.empty())
+                continue;
+            const bin_id& bin = bin_buffer.first;
+            if (out_streams_.find(bin) == out_streams_.end()) {
+                Init(bin);
+            }
+            out_streams_[bin]->write(buffer.left, buffer.right);
+            buffer.left.clear();
+            buffer.right.clear();
+        }
+    }
 }
 
 void ContigBinner::Run(io::PairedStream& paired_reads) {
+    static const size_t read_batch_size = 100000;
+    thread_buffers_.resize(omp_get_max_threads());
+
+    std::vector<io::PairedRead> batch;
+    batch.reserve(read_batch_size);
     io::PairedRead paired_read;
     while (!paired_reads.eof()) {
-        paired_reads >> paired_read;
-        set<bin_id> bins;
-        insert_all(bins, RelevantBins(paired_read.first()));
-        insert_all(bins, RelevantBins(paired_read.second()));
-        for (auto bin : bins) {
-            if (out_streams_.find(bin) == out_streams_.end()) {
-                Init(bin);
+        batch.clear();
+        while (batch.size() < read_batch_size && !paired_reads.eof()) {
+            paired_reads >> paired_read;
+            batch.push_back(paired_read);
+        }
+
+        //static schedule keeps the output order reproducible
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const io::PairedRead& read = batch[i];
+            set<bin_id> bins;
+            insert_all(bins, RelevantBins(read.first()));
+            insert_all(bins, RelevantBins(read.second()));
+            auto& buffers = thread_buffers_[omp_get_thread_num()];
+            for (const auto& bin : bins) {
+                BinBuffer& buffer = buffers[bin];
+                io::OSingleReadStream::Append(read.first(), buffer.left);
+                io::OSingleReadStream::Append(read.second(), buffer.right);
             }
-            (*(out_streams_[bin])) << paired_read;
         }
+
+        Flush();
     }
 }
 
@@ -8,27 +8,64 @@
 
 #include "annotation.hpp"
 #include "io/reads/io_helper.hpp"
+#include <zlib.h>
 
 namespace io {
 
 class OSingleReadStream {
     std::ofstream os_;
+    gzFile gz_os_;
 
 public:
-    OSingleReadStream(const std::string& fn) :
-        os_(fn) {
+    OSingleReadStream(const std::string& fn, bool gzip = false) :
+        gz_os_(nullptr) {
+        if (gzip) {
+            gz_os_ = gzopen(fn.c_str(), "wb");
+            VERIFY_MSG(gz_os_ != nullptr, "Failed to open " << fn);
+        } else {
+            os_.open(fn);
+        }
+    }
+
+    ~OSingleReadStream() {
+        close();
+    }
+
+    static void Append(const SingleRead& read, std::string& buffer) {
+        buffer += '@';
+        buffer += read.name();
+        buffer += '\n';
+        buffer += read.GetSequenceString();
+        buffer += "\n+\n";
+        buffer += read.GetPhredQualityString();
+        buffer += '\n';
+    }
+
+    //writes the block of already formatted reads
+    void write(const std::string& buffer) {
+        if (buffer.empty())
+            return;
+        if (gz_os_) {
+            VERIFY(gzwrite(gz_os_, buffer.data(), (unsigned) buffer.size()) == (int) buffer.size());
+        } else {
+            os_.write(buffer.data(), buffer.size());
+        }
     }
 
     OSingleReadStream& operator<<(const SingleRead& read) {
-        os_ << "@" << read.name() << std::endl;
-        os_ << read.GetSequenceString() << std::endl;
-        os_ << "+" << std::endl;
-        os_ << read.GetPhredQualityString() << std::endl;
+        std::string buffer;
+        Append(read, buffer);
+        write(buffer);
         return *this;
     }
 
     void close() {
-        os_.close();
+        if (gz_os_) {
+            gzclose(gz_os_);
+            gz_os_ = nullptr;
+        } else {
+            os_.close();
+        }
     }
 };
 
@@ -37,8 +74,8 @@ class OPairedReadStream {
     OSingleReadStream r_os_;
 
 public:
-    OPairedReadStream(const std::string& l_fn, const std::string& r_fn) :
-        l_os_(l_fn), r_os_(r_fn) {
+    OPairedReadStream(const std::string& l_fn, const std::string& r_fn, bool gzip = false) :
+        l_os_(l_fn, gzip), r_os_(r_fn, gzip) {
     }
 
     OPairedReadStream& operator<<(const PairedRead& read) {
@@ -47,6 +84,12 @@ public:
         return *this;
     }
 
+    //left and right blocks must contain the same number of reads
+    void write(const std::string& l_buffer, const std::string& r_buffer) {
+        l_os_.write(l_buffer);
+        r_os_.write(r_buffer);
+    }
+
     void close() {
         l_os_.close();
         r_os_.close();
@@ -64,24 +107,38 @@ class ContigBinner {
     std::string sample_name_;
     shared_ptr<SequenceMapper<Graph>> mapper_;
 
+    bool gzip_;
+
     map<bin_id, std::shared_ptr<io::OPairedReadStream>> out_streams_;
 
+    //formatted reads, accumulated by every thread for every bin
+    struct BinBuffer {
+        std::string left;
+        std::string right;
+    };
+    std::vector<std::unordered_map<bin_id, BinBuffer>> thread_buffers_;
+
     set<bin_id> RelevantBins(const io::SingleRead& r) const;
 
     void Init(bin_id bin);
 
+    void Flush();
+
 public:
     ContigBinner(const conj_graph_pack& gp, 
                  const EdgeAnnotation& edge_annotation,
                  const std::string& out_root,
-                 const std::string& sample_name) :
+                 const std::string& sample_name,
+                 bool gzip = false) :
                      gp_(gp),
                      edge_annotation_(edge_annotation),
                      out_root_(out_root),
                      sample_name_(sample_name),
-                     mapper_(MapperInstance(gp)) {
+                     mapper_(MapperInstance(gp)),
+                     gzip_(gzip) {
     }
 
+    //reads are mapped by batches in parallel, pairing is preserved within every bin
     void Run(io::PairedStream& paired_reads);
 
     void close() {
@@ -168,6 +168,7 @@ void estimate_distance(conj_graph_pack& gp,
             VERIFY_MSG(false, "Unexpected estimation mode value")
         }
     }
+    dist_finder.ReportCacheStats();
 
     INFO("Refining clustered pair information ");                             // this procedure checks, whether index
     RefinePairedInfo(gp.g, clustered_index);                                  // contains intersecting paired info clusters,
@@ -183,10 +184,8 @@ void estimate_distance(conj_graph_pack& gp,
         INFO("Filling scaffolding index");
 
         double is_var = lib.data().insert_size_deviation;
-        size_t delta = size_t(is_var);
         size_t linkage_distance = size_t(cfg::get().de.linkage_distance_coeff * is_var);
-        GraphDistanceFinder<Graph> dist_finder(gp.g, (size_t) math::round(lib.data().mean_insert_size),
-                                               lib.data().read_length, delta);
+        // graph distances do not depend on estimator parameters, so path lengths cached above are reused
         size_t max_distance = size_t(cfg::get().de.max_distance_coeff_scaff * is_var);
         std::function<double(int)> weight_function;
 
@@ -214,6 +213,7 @@ void estimate_distance(conj_graph_pack& gp,
                                                   cfg::get().ade.percentage,
                                                   cfg::get().ade.derivative_threshold, true);
         estimate_with_estimator<Graph>(gp.g, estimator, checker, scaffolding_index);
+        dist_finder.ReportCacheStats();
     }
 }
 
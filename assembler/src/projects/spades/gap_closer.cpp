@@ -10,6 +10,7 @@
 #include "modules/simplification/compressor.hpp"
 #include "io/dataset_support/read_converter.hpp"
 #include <stack>
+#include <unordered_set>
 
 namespace debruijn_graph {
 
@@ -168,6 +169,22 @@ class GapCloser {
     typedef typename Graph::EdgeId EdgeId;
     typedef typename Graph::VertexId VertexId;
 
+    //Graph edit closing the gap between the end of first and the start of second edge
+    struct Closure {
+        enum class Type {
+            None, Simple, CorrectLeft, CorrectRight
+        };
+
+        EdgeId first;
+        EdgeId second;
+        Type type;
+        int overlap;
+        vector<size_t> diff_pos;
+
+        Closure(EdgeId first_, EdgeId second_)
+                : first(first_), second(second_), type(Type::None), overlap(0) {}
+    };
+
     Graph &g_;
     int k_;
     omnigraph::de::PairedInfoIndexT<Graph> &tips_paired_idx_;
@@ -272,52 +289,56 @@ class GapCloser {
                 new_sequence);
     }
 
-    bool HandlePositiveHammingDistanceCase(EdgeId first, EdgeId second, int overlap) {
+    void HandlePositiveHammingDistanceCase(Closure &closure) const {
         DEBUG("Match was imperfect. Trying to correct one of the tips");
+        EdgeId first = closure.first, second = closure.second;
+        int overlap = closure.overlap;
         vector<size_t> diff_pos = DiffPos(g_.EdgeNucls(first).Last(overlap),
                                           g_.EdgeNucls(second).First(overlap));
         if (CanCorrectLeft(first, overlap, diff_pos)) {
-            CorrectLeft(first, second, overlap, diff_pos);
-            return true;
+            closure.type = Closure::Type::CorrectLeft;
+            closure.diff_pos = std::move(diff_pos);
         } else if (CanCorrectRight(second, overlap, diff_pos)) {
-            CorrectRight(first, second, overlap, diff_pos);
-            return true;
+            closure.type = Closure::Type::CorrectRight;
+            closure.diff_pos = std::move(diff_pos);
         } else {
             DEBUG("Can't correct tips due to the graph structure");
-            return false;
         }
     }
 
-    bool HandleSimpleCase(EdgeId first, EdgeId second, int overlap) {
+    void HandleSimpleCase(Closure &closure) const {
         DEBUG("Match was perfect. No correction needed");
-        DEBUG("Overlap " << overlap);
+        DEBUG("Overlap " << closure.overlap);
         //strange info guard
-        VERIFY(overlap <= k_);
-        if (overlap == k_) {
+        VERIFY(closure.overlap <= k_);
+        if (closure.overlap == k_) {
             DEBUG("Tried to close zero gap");
-            return false;
+            return;
         }
+        closure.type = Closure::Type::Simple;
+    }
+
+    void CloseSimpleGap(EdgeId first, EdgeId second, int overlap) {
         //old code
         Sequence edge_sequence = g_.EdgeNucls(first).Last(k_)
                                  + g_.EdgeNucls(second).Subseq(overlap, k_);
         DEBUG("Gap filled: Gap size = " << k_ - overlap << "  Result seq "
               << edge_sequence.str());
         g_.AddEdge(g_.EdgeEnd(first), g_.EdgeStart(second), edge_sequence);
-        return true;
     }
 
-    bool ProcessPair(EdgeId first, EdgeId second) {
+    //Only reads the graph, hence can be called concurrently
+    Closure EvaluatePair(EdgeId first, EdgeId second) const {
         TRACE("Processing edges " << g_.str(first) << " and " << g_.str(second));
         TRACE("first " << g_.EdgeNucls(first) << " second " << g_.EdgeNucls(second));
+        Closure closure(first, second);
 
         if (cfg::get().avoid_rc_connections &&
             (first == g_.conjugate(second) || first == second)) {
             DEBUG("Trying to join conjugate edges " << g_.int_id(first));
-            return false;
+            return closure;
         }
 
-        Sequence seq1 = g_.EdgeNucls(first);
-        Sequence seq2 = g_.EdgeNucls(second);
         TRACE("Checking possible gaps from 1 to " << k_ - min_intersection_);
         for (int gap = 1; gap <= k_ - (int) min_intersection_; ++gap) {
             int overlap = k_ - gap;
@@ -331,14 +352,44 @@ class GapCloser {
                 //                << seq1.Subseq(seq1.size() - k).str() << "  "
                 //                << seq2.Subseq(0, k).str());
 
+                closure.overlap = overlap;
                 if (hamming_distance > 0) {
-                    return HandlePositiveHammingDistanceCase(first, second, overlap);
+                    HandlePositiveHammingDistanceCase(closure);
                 } else {
-                    return HandleSimpleCase(first, second, overlap);
+                    HandleSimpleCase(closure);
                 }
+                return closure;
             }
         }
-        return false;
+        return closure;
+    }
+
+    void Apply(const Closure &closure) {
+        switch (closure.type) {
+            case Closure::Type::Simple:
+                CloseSimpleGap(closure.first, closure.second, closure.overlap);
+                break;
+            case Closure::Type::CorrectLeft:
+                CorrectLeft(closure.first, closure.second, closure.overlap, closure.diff_pos);
+                break;
+            case Closure::Type::CorrectRight:
+                CorrectRight(closure.first, closure.second, closure.overlap, closure.diff_pos);
+                break;
+            default:
+                VERIFY(false);
+        }
+    }
+
+    bool ProcessPair(EdgeId first, EdgeId second) {
+        Closure closure = EvaluatePair(first, second);
+        if (closure.type == Closure::Type::None)
+            return false;
+        Apply(closure);
+        return true;
+    }
+
+    bool IsGap(EdgeId first_edge, EdgeId second_edge) const {
+        return g_.IsDeadEnd(g_.EdgeEnd(first_edge)) && g_.IsDeadStart(g_.EdgeStart(second_edge));
     }
 
 public:
@@ -354,7 +405,7 @@ public:
                 if (first_edge == second_edge)
                     continue;
 
-                if (!g_.IsDeadEnd(g_.EdgeEnd(first_edge)) || !g_.IsDeadStart(g_.EdgeStart(second_edge))) {
+                if (!IsGap(first_edge, second_edge)) {
                     // WARN("Topologically wrong tips");
                     continue;
                 }
@@ -382,6 +433,76 @@ public:
         omnigraph::CompressAllVertices<Graph>(g_);
     }
 
+    /*
+     * Candidate gaps are evaluated concurrently against the unmodified graph,
+     * then closures are applied serially in the same order as in CloseShortGaps.
+     * Closure is skipped if its tips were already joined or split by previously applied ones,
+     * so the result matches the serial procedure unless split edges are involved.
+     */
+    void CloseShortGapsParallel() {
+        INFO("Closing short gaps in parallel");
+        std::vector<Closure> candidates;
+        //candidates for the i-th first edge are [group_starts[i], group_starts[i + 1])
+        std::vector<size_t> group_starts;
+        size_t gaps_checked = 0;
+        for (auto edge = g_.SmartEdgeBegin(); !edge.IsEnd(); ++edge) {
+            EdgeId first_edge = *edge;
+            group_starts.push_back(candidates.size());
+            for (auto i : tips_paired_idx_.Get(first_edge)) {
+                EdgeId second_edge = i.first;
+                if (first_edge == second_edge || !IsGap(first_edge, second_edge))
+                    continue;
+
+                size_t points = 0;
+                for (auto point : i.second)
+                    if (!math::ls(point.weight, weight_threshold_))
+                        ++points;
+                if (points) {
+                    gaps_checked += points;
+                    candidates.emplace_back(first_edge, second_edge);
+                }
+            }
+        }
+        group_starts.push_back(candidates.size());
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (size_t i = 0; i < candidates.size(); ++i)
+            candidates[i] = EvaluatePair(candidates[i].first, candidates[i].second);
+
+        size_t closable = 0, gaps_filled = 0, conflicts = 0;
+        std::unordered_set<EdgeId> split_edges;
+        for (size_t group = 0; group + 1 < group_starts.size(); ++group) {
+            for (size_t i = group_starts[group]; i < group_starts[group + 1]; ++i) {
+                const Closure &closure = candidates[i];
+                if (closure.type == Closure::Type::None)
+                    continue;
+
+                ++closable;
+                if (split_edges.count(closure.first) || split_edges.count(closure.second) ||
+                    !IsGap(closure.first, closure.second)) {
+                    ++conflicts;
+                    continue;
+                }
+
+                if (closure.type == Closure::Type::CorrectLeft) {
+                    split_edges.insert(closure.first);
+                    split_edges.insert(g_.conjugate(closure.first));
+                } else if (closure.type == Closure::Type::CorrectRight) {
+                    split_edges.insert(closure.second);
+                    split_edges.insert(g_.conjugate(closure.second));
+                }
+                Apply(closure);
+                ++gaps_filled;
+                break;
+            }
+        }
+
+        INFO("Closing short gaps complete: " << candidates.size() << " candidates evaluated ("
+             << gaps_checked << " checked), " << closable << " closable, filled " << gaps_filled
+             << " gaps, " << conflicts << " conflicting closures skipped");
+        omnigraph::CompressAllVertices<Graph>(g_);
+    }
+
     GapCloser(Graph &g, omnigraph::de::PairedInfoIndexT<Graph> &tips_paired_idx,
               size_t min_intersection, double weight_threshold,
               size_t hamming_dist_bound = 0 /*min_intersection_ / 5*/)
@@ -410,7 +531,10 @@ void CloseGaps(conj_graph_pack &gp, Streams &streams) {
     gcpif.FillIndex(tips_paired_idx, streams);
     GapCloser gap_closer(gp.g, tips_paired_idx,
                          cfg::get().gc.minimal_intersection, cfg::get().gc.weight_threshold);
-    gap_closer.CloseShortGaps();
+    if (cfg::get().gc.parallel)
+        gap_closer.CloseShortGapsParallel();
+    else
+        gap_closer.CloseShortGaps();
 }
 
 void GapClosing::run(conj_graph_pack &gp, const char *) {
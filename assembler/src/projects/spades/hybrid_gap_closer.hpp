@@ -13,7 +13,10 @@
 #include "ConsensusCore/Poa/PoaConsensus.hpp"
 #include "gap_closing.hpp"
 
+#include "utils/perfcounter.hpp"
+
 #include <algorithm>
+#include <numeric>
 #include <fstream>
 
 namespace debruijn_graph {
@@ -331,9 +334,9 @@ public:
 };
 
 inline string PoaConsensus(const vector<string>& gap_seqs) {
-    const ConsensusCore::PoaConsensus* pc = ConsensusCore::PoaConsensus::FindConsensus(
+    std::unique_ptr<const ConsensusCore::PoaConsensus> pc(ConsensusCore::PoaConsensus::FindConsensus(
             gap_seqs,
-            ConsensusCore::PoaConfig::GLOBAL_ALIGNMENT);
+            ConsensusCore::PoaConfig::GLOBAL_ALIGNMENT));
     return pc->Sequence();
 }
 
@@ -594,17 +597,42 @@ private:
                                       const vector<string>& gap_variants) const {
         DEBUG(gap_variants.size() << " gap closing variants, lengths: " << PrintLengths(gap_variants));
         DEBUG("var size original " << gap_variants.size());
-        vector<string> new_gap_variants(gap_variants.begin(), gap_variants.end());
-        new_gap_variants.resize(std::min(max_consensus_reads_, gap_variants.size()));
-        auto s = consensus_(new_gap_variants);
+        perf_counter perf;
+        auto s = consensus_(SubsampleVariants(gap_variants));
         DEBUG("consenus for " << g_.int_id(start)
                               << " and " << g_.int_id(end)
-                              << " found: '" << s << "'");
+                              << " found in " << perf.time_ms() << " ms: '" << s << "'");
         return GapDescription(start, end,
                               Sequence(s),
                               edge_gap_start_position, edge_gap_end_position);
     }
 
+    //Variants are evenly picked from the whole list (first one is always taken)
+    vector<string> SubsampleVariants(const vector<string>& gap_variants) const {
+        if (gap_variants.size() <= max_consensus_reads_)
+            return gap_variants;
+
+        vector<string> answer;
+        answer.reserve(max_consensus_reads_);
+        for (size_t i = 0; i < max_consensus_reads_; ++i)
+            answer.push_back(gap_variants[i * gap_variants.size() / max_consensus_reads_]);
+        return answer;
+    }
+
+    //Rough estimate of consensus construction time, used to balance the load
+    size_t ConsensusCost(EdgeId e) const {
+        size_t cost = 0;
+        for (const auto& edge_pair_gaps : storage_.EdgePairGaps(get(storage_.inner_index(), e))) {
+            size_t cnt = edge_pair_gaps.second - edge_pair_gaps.first;
+            size_t total_len = 0;
+            for (auto it = edge_pair_gaps.first; it != edge_pair_gaps.second; ++it)
+                total_len += it->gap_seq.size();
+            size_t avg_len = total_len / cnt + 1;
+            cost += std::min(cnt, max_consensus_reads_) * avg_len * avg_len;
+        }
+        return cost;
+    }
+
     //all gaps guaranteed to correspond to a single edge pair
     GapInfos PadGaps(gap_info_it start, gap_info_it end) const {
         size_t start_min = std::numeric_limits<size_t>::max();
@@ -695,22 +723,38 @@ private:
     }
 
     vector<GapDescription> ConstructConsensus() const {
-        vector<vector<GapDescription>> closures_by_thread(omp_get_max_threads());
-
-        # pragma omp parallel for
-        for (size_t i = 0; i < storage_.size(); i++) {
-            EdgeId e = storage_[i];
-            size_t thread_num = omp_get_thread_num();
-            GapDescription gap = ConstructConsensus(e);
-            if (gap != INVALID_GAP) {
-                closures_by_thread[thread_num].push_back(gap);
-            }
+        //edges with the most expensive consensus are processed first
+        vector<std::pair<size_t, size_t>> cost_idx(storage_.size());
+        for (size_t i = 0; i < storage_.size(); ++i)
+            cost_idx[i] = std::make_pair(ConsensusCost(storage_[i]), i);
+        std::stable_sort(cost_idx.begin(), cost_idx.end(),
+                         [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+            return a.first > b.first;
+        });
+
+        vector<GapDescription> closures_by_edge(storage_.size(), INVALID_GAP);
+        vector<double> times(storage_.size(), 0.);
+
+        perf_counter perf;
+        # pragma omp parallel for schedule(dynamic, 1)
+        for (size_t j = 0; j < cost_idx.size(); j++) {
+            size_t i = cost_idx[j].second;
+            perf_counter edge_perf;
+            closures_by_edge[i] = ConstructConsensus(storage_[i]);
+            times[i] = edge_perf.time();
+        }
+
+        size_t slowest = std::max_element(times.begin(), times.end()) - times.begin();
+        if (!times.empty()) {
+            INFO("Consensus for " << times.size() << " edges constructed in " << perf.time() << " s ("
+                 << std::accumulate(times.begin(), times.end(), 0.) << " s of thread time), slowest edge "
+                 << g_.int_id(storage_[slowest]) << " took " << times[slowest] << " s");
         }
 
         vector<GapDescription> closures;
-        for (auto& new_per_thread : closures_by_thread) {
-            std::copy(new_per_thread.begin(), new_per_thread.end(), std::back_inserter(closures));
-            new_per_thread.clear();
+        for (const auto& gap : closures_by_edge) {
+            if (gap != INVALID_GAP)
+                closures.push_back(gap);
         }
         return closures;
     }
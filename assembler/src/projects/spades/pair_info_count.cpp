@@ -23,6 +23,7 @@ namespace debruijn_graph {
 typedef io::SequencingLibrary<config::DataSetData> SequencingLib;
 using PairedInfoFilter = bf::counting_bloom_filter<std::pair<EdgeId, EdgeId>, 2>;
 using EdgePairCounter = hll::hll<std::pair<EdgeId, EdgeId>>;
+using ReadMappingCache = SequenceMapperNotifier::MappingCacheT;
 
 class DEFilter : public SequenceMapperListener {
   public:
@@ -112,7 +113,8 @@ class EdgePairCounterFiller : public SequenceMapperListener {
 
 static bool CollectLibInformation(const conj_graph_pack &gp,
                                   size_t &edgepairs,
-                                  size_t ilib, size_t edge_length_threshold) {
+                                  size_t ilib, size_t edge_length_threshold,
+                                  ReadMappingCache &mapping_cache) {
     INFO("Estimating insert size (takes a while)");
     InsertSizeCounter hist_counter(gp, edge_length_threshold);
     EdgePairCounterFiller pcounter(cfg::get().max_threads);
@@ -121,6 +123,18 @@ static bool CollectLibInformation(const conj_graph_pack &gp,
     notifier.Subscribe(ilib, &hist_counter);
     notifier.Subscribe(ilib, &pcounter);
 
+    size_t sample_size = cfg::get().de.is_sample_size;
+    double sample_tolerance = cfg::get().de.is_sample_tolerance;
+    if (sample_size) {
+        //Mappings are cached during the next pass over the whole library
+        INFO("Insert size is estimated over a sample of at least " << sample_size << " aligned pairs");
+        notifier.StopWhen([&hist_counter, sample_size, sample_tolerance]() {
+            return hist_counter.Converged(sample_size, sample_tolerance);
+        });
+    } else {
+        notifier.UseMappingCache(mapping_cache);
+    }
+
     SequencingLib &reads = cfg::get_writable().ds.reads[ilib];
     auto &data = reads.data();
     auto paired_streams = paired_binary_readers(reads, false);
@@ -129,8 +143,15 @@ static bool CollectLibInformation(const conj_graph_pack &gp,
     //Check read length after lib processing since mate pairs a not used until this step
     VERIFY(reads.data().read_length != 0);
 
+    const size_t rough_edgepairs = 64ull * 1024 * 1024;
     auto pres = pcounter.cardinality();
-    edgepairs = (!pres.second ? 64ull * 1024 * 1024 : size_t(pres.first));
+    edgepairs = (!pres.second ? rough_edgepairs : size_t(pres.first));
+    if (pres.second && sample_size) {
+        //data.read_count also counts single reads, so the number of pairs is taken from paired streams,
+        //which report both reads of each pair
+        size_t total_pairs = paired_streams.get_stat().read_count_ / 2;
+        edgepairs = ExtrapolateEdgePairs(edgepairs, hist_counter.total(), total_pairs, rough_edgepairs);
+    }
     INFO("Edge pairs: " << edgepairs << (!pres.second ? " (rough upper limit)" : ""));
 
     INFO(hist_counter.mapped() << " paired reads (" <<
@@ -185,7 +206,7 @@ void ProcessSingleReads(conj_graph_pack &gp,
 
 static void ProcessPairedReads(conj_graph_pack &gp,
                                std::unique_ptr<PairedInfoFilter> filter, unsigned filter_threshold,
-                               size_t ilib) {
+                               size_t ilib, ReadMappingCache &mapping_cache) {
     SequencingLib &reads = cfg::get_writable().ds.reads[ilib];
     const auto &data = reads.data();
 
@@ -198,6 +219,7 @@ static void ProcessPairedReads(conj_graph_pack &gp,
                                       cfg::get().de.rounding_thr));
 
     SequenceMapperNotifier notifier(gp);
+    notifier.UseMappingCache(mapping_cache);
     INFO("Left insert size quantile " << data.insert_size_left_quantile <<
          ", right insert size quantile " << data.insert_size_right_quantile <<
          ", filtering threshold " << filter_threshold <<
@@ -313,8 +335,11 @@ void PairInfoCount::run(conj_graph_pack &gp, const char *) {
                 size_t rl = lib_data.read_length;
                 size_t k = cfg::get().K;
 
+                //all passes over the library below map reads to the same graph
+                ReadMappingCache mapping_cache(gp.g, cfg::get().max_memory * (1ull << 30) / 4);
+
                 size_t edgepairs = 0;
-                if (!CollectLibInformation(gp, edgepairs, i, edge_length_threshold)) {
+                if (!CollectLibInformation(gp, edgepairs, i, edge_length_threshold, mapping_cache)) {
                     cfg::get_writable().ds.reads[i].data().mean_insert_size = 0.0;
                     WARN("Unable to estimate insert size for paired library #" << i);
                     if (rl > 0 && rl <= k) {
@@ -351,6 +376,7 @@ void PairInfoCount::run(conj_graph_pack &gp, const char *) {
                     INFO("Filtering data for library #" << i);
                     {
                         SequenceMapperNotifier notifier(gp);
+                        notifier.UseMappingCache(mapping_cache);
                         DEFilter filter_counter(*filter, gp.g);
                         notifier.Subscribe(i, &filter_counter);
 
@@ -363,7 +389,7 @@ void PairInfoCount::run(conj_graph_pack &gp, const char *) {
                 INFO("Mapping library #" << i);
                 if (lib.data().mean_insert_size != 0.0) {
                     INFO("Mapping paired reads (takes a while) ");
-                    ProcessPairedReads(gp, std::move(filter), filter_threshold, i);
+                    ProcessPairedReads(gp, std::move(filter), filter_threshold, i, mapping_cache);
                 }
             }
 
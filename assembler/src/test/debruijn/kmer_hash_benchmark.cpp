@@ -0,0 +1,107 @@
+//***************************************************************************
+//* Copyright (c) 2016 Saint Petersburg State University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+/*
+ * Compares k-mer index lookups along a sequence for the default (CityHash based)
+ * and the rolling index traits.
+ */
+
+#include "utils/standard_base.hpp"
+#include "utils/simple_tools.hpp"
+#include "utils/perfcounter.hpp"
+#include "utils/logger/log_writers.hpp"
+
+#include "assembly_graph/core/graph.hpp"
+#include "utils/indices/perfect_hash_map_builder.hpp"
+#include "utils/indices/kmer_splitters.hpp"
+
+#include <random>
+
+void create_console_logger() {
+    logging::logger *log = logging::create_logger("", logging::L_INFO);
+    log->add_writer(std::make_shared<logging::console_writer>());
+    logging::attach_logger(log);
+}
+
+namespace debruijn_graph {
+
+template<class traits>
+using BenchmarkKMerMap = KeyStoringMap<RtSeq, unsigned, traits, InvertableStoring>;
+
+Sequence RandomSequence(size_t length, unsigned seed) {
+    std::mt19937 rand(seed);
+    std::string s(length, 'A');
+    for (size_t i = 0; i < length; ++i)
+        s[i] = nucl(char(rand() & 3));
+    return Sequence(s);
+}
+
+template<class Index>
+void BuildBenchmarkIndex(Index &index, const Graph &g) {
+    DeBruijnGraphKMerSplitter<Graph, StoringTypeFilter<InvertableStoring>,
+                              typename Index::traits_t>
+            splitter(index.workdir(), index.k(), g);
+    KMerDiskCounter<RtSeq> counter(index.workdir(), splitter);
+    BuildIndex(index, counter, 16, 1);
+}
+
+//Shifts the key with hash along the sequence, computing the index only (idx) or also checking the key (valid)
+template<class Index>
+void Walk(const std::string &name, const Index &index, const Sequence &s, size_t k, size_t rounds) {
+    size_t checksum = 0, found = 0;
+    perf_counter pc;
+    for (size_t i = 0; i < rounds; ++i) {
+        auto kwh = index.ConstructKWH(s.start<RtSeq>(k) >> 'A');
+        for (size_t j = k - 1; j < s.size(); ++j) {
+            kwh <<= s[j];
+            checksum += kwh.idx();
+        }
+    }
+    double idx_time = pc.time_ms();
+    pc.reset();
+    for (size_t i = 0; i < rounds; ++i) {
+        auto kwh = index.ConstructKWH(s.start<RtSeq>(k) >> 'A');
+        for (size_t j = k - 1; j < s.size(); ++j) {
+            kwh <<= s[j];
+            found += index.valid(kwh);
+        }
+    }
+    double lookup_time = pc.time_ms();
+    VERIFY(found == rounds * (s.size() - k + 1));
+    INFO(name << ": index computation " << size_t(idx_time) << " ms, lookups " << size_t(lookup_time)
+         << " ms (checksum " << checksum << ")");
+}
+
+void Launch(size_t k, size_t length, size_t rounds) {
+    TmpFolderFixture tmp_dir("tmp");
+    Sequence s = RandomSequence(length, 42);
+    Graph g(k);
+    g.AddEdge(g.AddVertex(), g.AddVertex(), s);
+
+    BenchmarkKMerMap<kmer_index_traits<RtSeq>> plain(k, "tmp");
+    BuildBenchmarkIndex(plain, g);
+    BenchmarkKMerMap<rolling_kmer_index_traits<RtSeq>> rolling(k, "tmp");
+    BuildBenchmarkIndex(rolling, g);
+
+    INFO("Walking " << rounds << " times along a sequence of length " << length << ", k = " << k);
+    Walk("default hash", plain, s, k, rounds);
+    Walk("rolling hash", rolling, s, k, rounds);
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        cout << "Usage: kmer_hash_benchmark <K> [<sequence length> [<rounds>]]" << endl;
+        exit(1);
+    }
+    create_console_logger();
+    size_t K = std::stoll(argv[1]);
+    size_t length = argc > 2 ? std::stoll(argv[2]) : 200000;
+    size_t rounds = argc > 3 ? std::stoll(argv[3]) : 5;
+    debruijn_graph::Launch(K, length, rounds);
+    return 0;
+}
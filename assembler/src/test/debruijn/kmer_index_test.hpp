@@ -0,0 +1,82 @@
+//***************************************************************************
+//* Copyright (c) 2016 Saint Petersburg State University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils.hpp"
+#include "utils/indices/perfect_hash_map_builder.hpp"
+
+#include <random>
+
+namespace debruijn_graph {
+
+BOOST_FIXTURE_TEST_SUITE(kmer_index_tests, TmpFolderFixture)
+
+template<class traits>
+using TestKMerMap = KeyStoringMap<RtSeq, unsigned, traits, InvertableStoring>;
+
+inline Sequence RandomSequence(size_t length, unsigned seed) {
+    std::mt19937 rand(seed);
+    std::string s(length, 'A');
+    for (size_t i = 0; i < length; ++i)
+        s[i] = nucl(char(rand() & 3));
+    return Sequence(s);
+}
+
+template<class Index>
+void BuildTestIndex(Index &index, const Graph &g) {
+    DeBruijnGraphKMerSplitter<Graph, StoringTypeFilter<InvertableStoring>,
+                              typename Index::traits_t>
+            splitter(index.workdir(), index.k(), g);
+    KMerDiskCounter<RtSeq> counter(index.workdir(), splitter);
+    BuildIndex(index, counter, 16, 1);
+}
+
+BOOST_AUTO_TEST_CASE( RollingHashStructuredCollisions ) {
+    //positions 0..30 and 33..63 cancel out in hashes rotating 33- and 31-bit halves
+    const size_t k = 77;
+    std::string s1(k, 'A'), s2(k, 'A');
+    for (size_t i = 0; i < 64; ++i) {
+        if (i != 31 && i != 32)
+            s2[i] = 'C';
+    }
+    KMerDigest fwd1, rc1, fwd2, rc2;
+    RollingHash::Digests(RtSeq(k, s1), fwd1, rc1);
+    RollingHash::Digests(RtSeq(k, s2), fwd2, rc2);
+    BOOST_CHECK(fwd1 != fwd2);
+    BOOST_CHECK(RollingHash::Canonical(fwd1, rc1) != RollingHash::Canonical(fwd2, rc2));
+}
+
+BOOST_AUTO_TEST_CASE( RollingKeyWithHash ) {
+    const size_t k = 55;
+    Sequence s = RandomSequence(20000, 239);
+    Graph g(k);
+    g.AddEdge(g.AddVertex(), g.AddVertex(), s);
+
+    TestKMerMap<rolling_kmer_index_traits<RtSeq>> index(k, "tmp");
+    BuildTestIndex(index, g);
+    BOOST_CHECK_EQUAL(s.size() - k + 1, index.size());
+
+    auto kwh = index.ConstructKWH(s.start<RtSeq>(k));
+    for (size_t j = k; ; ++j) {
+        RtSeq kmer = kwh.key();
+        auto fresh = index.ConstructKWH(kmer);
+        BOOST_CHECK_EQUAL(fresh.idx(), kwh.idx());
+        BOOST_CHECK(index.valid(kwh));
+        BOOST_CHECK_EQUAL(kmer.IsMinimal() ? kmer : !kmer, index.true_kmer(kwh));
+        BOOST_CHECK_EQUAL((!kwh).idx(), index.ConstructKWH(!kmer).idx());
+        BOOST_CHECK_EQUAL((kwh >> 'A').idx(), index.ConstructKWH(kmer >> 'A').idx());
+        if (j == s.size())
+            break;
+        kwh <<= s[j];
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,112 @@
+//***************************************************************************
+//* Copyright (c) 2016 Saint Petersburg State University
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils.hpp"
+#include "modules/alignment/long_read_storage.hpp"
+
+namespace debruijn_graph {
+
+BOOST_FIXTURE_TEST_SUITE(long_read_storage_tests, TmpFolderFixture)
+
+typedef vector<pair<vector<EdgeId>, size_t>> WeightedPaths;
+
+inline WeightedPaths AllPaths(const PathStorage<Graph> &storage) {
+    vector<PathInfo<Graph>> paths;
+    storage.SaveAllPaths(paths);
+    WeightedPaths res;
+    for (const auto &path : paths)
+        res.push_back(make_pair(path.getPath(), path.getWeight()));
+    return res;
+}
+
+inline vector<EdgeId> SortedEdges(const Graph &g) {
+    vector<EdgeId> edges;
+    for (auto it = g.ConstEdgeBegin(); !it.IsEnd(); ++it)
+        edges.push_back(*it);
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+BOOST_AUTO_TEST_CASE( PathStorageWeightsAndOrder ) {
+    Graph g(13);
+    graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/path_extend/distance_estimation", g);
+    vector<EdgeId> e = SortedEdges(g);
+    BOOST_REQUIRE(e.size() >= 4);
+
+    PathStorage<Graph> storage(g);
+    storage.AddPath({e[2], e[0]}, 1);
+    storage.AddPath({e[1]}, 1);
+    storage.AddPath({e[2], e[0]}, 2);
+    storage.AddPath({e[2]}, 1);
+    storage.AddPath({}, 1);
+    storage.AddPath({e[0], e[3]}, 4, true);
+    vector<EdgeId> rc = {g.conjugate(e[3]), g.conjugate(e[0])};
+
+    WeightedPaths expected = {
+        {{e[0], e[3]}, 4}, {{e[1]}, 1}, {{e[2]}, 1}, {{e[2], e[0]}, 3}, {rc, 4}
+    };
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(storage.size(), expected.size());
+    BOOST_CHECK(AllPaths(storage) == expected);
+
+    PathStorage<Graph> copy(storage);
+    BOOST_CHECK(AllPaths(copy) == expected);
+
+    PathStorage<Graph> merged(g);
+    merged.AddPath({e[1]}, 2);
+    merged.AddStorage(storage);
+    expected[1].second += 2;
+    BOOST_CHECK_EQUAL(merged.size(), expected.size());
+    BOOST_CHECK(AllPaths(merged) == expected);
+
+    storage.Clear();
+    BOOST_CHECK_EQUAL(storage.size(), 0);
+    BOOST_CHECK(AllPaths(storage).empty());
+}
+
+BOOST_AUTO_TEST_CASE( PathStorageReplaceEdges ) {
+    Graph g(13);
+    graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/path_extend/distance_estimation", g);
+    vector<EdgeId> e = SortedEdges(g);
+    BOOST_REQUIRE(e.size() >= 4);
+
+    PathStorage<Graph> storage(g);
+    storage.AddPath({e[0], e[3]}, 5);
+    storage.AddPath({e[1], e[3]}, 2);
+    storage.AddPath({e[2], e[1]}, 1);
+
+    map<EdgeId, EdgeId> replacement = {{e[0], e[1]}};
+    storage.ReplaceEdges(replacement);
+    //Paths coinciding after replacement are not merged, the first one is kept
+    WeightedPaths expected = {{{e[1], e[3]}, 5}, {{e[2], e[1]}, 1}};
+    BOOST_CHECK(AllPaths(storage) == expected);
+}
+
+BOOST_AUTO_TEST_CASE( PathStorageDumpAndLoad ) {
+    Graph g(13);
+    graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/path_extend/distance_estimation", g);
+    vector<EdgeId> e = SortedEdges(g);
+    BOOST_REQUIRE(e.size() >= 4);
+
+    PathStorage<Graph> storage(g);
+    storage.AddPath({e[0], e[3], e[1]}, 3);
+    storage.AddPath({e[0]}, 1);
+    storage.AddPath({e[2], e[0]}, 7, true);
+    storage.DumpToFile("tmp/long_reads.mpr");
+
+    PathStorage<Graph> loaded(g);
+    loaded.LoadFromFile("tmp/long_reads.mpr");
+    BOOST_CHECK_EQUAL(loaded.size(), storage.size());
+    BOOST_CHECK(AllPaths(loaded) == AllPaths(storage));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
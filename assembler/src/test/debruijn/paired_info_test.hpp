@@ -8,6 +8,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include "paired_info/paired_info_helpers.hpp"
+#include "paired_info/is_counter.hpp"
 
 namespace debruijn_graph {
 
@@ -435,6 +436,17 @@ BOOST_AUTO_TEST_CASE(PairedInfoPairTraverse) {
     BOOST_CHECK_EQUAL(GetEdgePairInfo(pi), test1);
 }
 
+BOOST_AUTO_TEST_CASE(EdgePairsExtrapolation) {
+    //whole library is sampled
+    BOOST_CHECK_EQUAL(ExtrapolateEdgePairs(500, 1000, 1000, 100000), 500u);
+    //linear extrapolation by the number of read pairs
+    BOOST_CHECK_EQUAL(ExtrapolateEdgePairs(500, 1000, 10000, 100000), 5000u);
+    //capped by the limit
+    BOOST_CHECK_EQUAL(ExtrapolateEdgePairs(500, 1000, 1000000, 100000), 100000u);
+    //but never below the sample count
+    BOOST_CHECK_EQUAL(ExtrapolateEdgePairs(500, 1000, 10000, 100), 500u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -20,6 +20,7 @@
 #include "test_utils.hpp"
 #include "modules/path_extend/path_visualizer.hpp"
 #include "modules/path_extend/pe_utils.hpp"
+#include "modules/path_extend/scaffolder2015/scaffold_graph.hpp"
 namespace path_extend {
 
 BOOST_FIXTURE_TEST_SUITE(path_extend_basic, TmpFolderFixture)
@@ -766,6 +767,98 @@ BOOST_AUTO_TEST_CASE( BidirectionalPathLoopDetector ) {
 }
 
 
+BOOST_AUTO_TEST_CASE( ScaffoldGraphRemoval ) {
+    typedef scaffold_graph::ScaffoldGraph ScaffoldGraph;
+    typedef std::multiset<std::pair<size_t, size_t>> EdgeEnds;
+
+    Graph g(13);
+    graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/path_extend/distance_estimation", g);
+
+    //scaffold vertices must not be conjugate to each other
+    vector<EdgeId> v;
+    for (auto it = g.ConstEdgeBegin(); !it.IsEnd(); ++it) {
+        EdgeId e = *it;
+        if (v.size() < 4 && g.conjugate(e) != e &&
+            std::find(v.begin(), v.end(), g.conjugate(e)) == v.end())
+            v.push_back(e);
+    }
+    BOOST_REQUIRE_EQUAL(v.size(), 4);
+    EdgeId a = v[0], b = v[1], c = v[2], d = v[3];
+
+    ScaffoldGraph sg(g);
+    for (EdgeId e : v)
+        BOOST_CHECK(sg.AddVertex(e));
+    BOOST_CHECK(!sg.AddVertex(g.conjugate(a)));
+    BOOST_CHECK_EQUAL(sg.VertexCount(), 8);
+
+    BOOST_CHECK(sg.AddEdge(a, b, 0, 1.));
+    BOOST_CHECK(sg.AddEdge(a, c, 0, 2.));
+    BOOST_CHECK(sg.AddEdge(b, c, 0, 3.));
+    BOOST_CHECK(sg.AddEdge(g.conjugate(d), g.conjugate(b), 1, 4.));
+    //last edge shares start with the edge removed below
+    BOOST_CHECK(sg.AddEdge(a, d, 0, 5.));
+    BOOST_CHECK(!sg.AddEdge(a, d, 0, 5.));
+    BOOST_CHECK_EQUAL(sg.EdgeCount(), 5);
+
+    auto ends = [&g](const vector<ScaffoldGraph::ScaffoldEdge> &edges) {
+        EdgeEnds res;
+        for (const auto &e : edges)
+            res.insert(std::make_pair(g.int_id(e.getStart()), g.int_id(e.getEnd())));
+        return res;
+    };
+    auto all_ends = [&](const ScaffoldGraph &graph) {
+        vector<ScaffoldGraph::ScaffoldEdge> edges;
+        for (const auto &e : graph.edges())
+            edges.push_back(e);
+        BOOST_CHECK_EQUAL(edges.size(), graph.EdgeCount());
+        return ends(edges);
+    };
+    auto pair_ids = [&g](EdgeId e1, EdgeId e2) {
+        return std::make_pair(g.int_id(e1), g.int_id(e2));
+    };
+
+    //a -> c occupies the middle of edge storage, a -> d is moved to its position
+    BOOST_CHECK(sg.RemoveEdge(ScaffoldGraph::ScaffoldEdge(a, c, 0, 2.)));
+    BOOST_CHECK(!sg.RemoveEdge(ScaffoldGraph::ScaffoldEdge(a, c, 0, 2.)));
+    BOOST_CHECK(!sg.Exists(ScaffoldGraph::ScaffoldEdge(a, c, 0, 2.)));
+    BOOST_CHECK(sg.Exists(ScaffoldGraph::ScaffoldEdge(a, d, 0, 5.)));
+    BOOST_CHECK_EQUAL(sg.EdgeCount(), 4);
+    BOOST_CHECK(ends(sg.OutgoingEdges(a)) == EdgeEnds({pair_ids(a, b), pair_ids(a, d)}));
+    BOOST_CHECK_EQUAL(sg.IncomingEdgeCount(c), 1);
+    BOOST_CHECK(sg.HasUniqueIncoming(c));
+    BOOST_CHECK(sg.UniqueIncoming(c) == ScaffoldGraph::ScaffoldEdge(b, c, 0, 3.));
+    BOOST_CHECK(sg.HasUniqueIncoming(d));
+    BOOST_CHECK(sg.UniqueIncoming(d) == ScaffoldGraph::ScaffoldEdge(a, d, 0, 5.));
+    BOOST_CHECK(all_ends(sg) == EdgeEnds({pair_ids(a, b), pair_ids(a, d), pair_ids(b, c),
+                                          pair_ids(g.conjugate(d), g.conjugate(b))}));
+
+    //removes edges adjacent both to b and to its conjugate
+    BOOST_CHECK(sg.RemoveVertex(b));
+    BOOST_CHECK(!sg.RemoveVertex(g.conjugate(b)));
+    BOOST_CHECK(!sg.Exists(b));
+    BOOST_CHECK(!sg.Exists(g.conjugate(b)));
+    BOOST_CHECK_EQUAL(sg.VertexCount(), 6);
+    BOOST_CHECK_EQUAL(sg.EdgeCount(), 1);
+    BOOST_CHECK(sg.HasUniqueOutgoing(a));
+    BOOST_CHECK(sg.UniqueOutgoing(a) == ScaffoldGraph::ScaffoldEdge(a, d, 0, 5.));
+    BOOST_CHECK(sg.IsVertexIsolated(c));
+    BOOST_CHECK(sg.IsVertexIsolated(g.conjugate(d)));
+    BOOST_CHECK_EQUAL(sg.OutgoingEdgeCount(b), 0);
+    BOOST_CHECK_EQUAL(sg.IncomingEdgeCount(g.conjugate(b)), 0);
+    BOOST_CHECK(all_ends(sg) == EdgeEnds({pair_ids(a, d)}));
+
+    //edges added after removals are indexed consistently
+    BOOST_CHECK(sg.AddEdge(d, a, 2, 6.));
+    BOOST_CHECK(sg.AddEdge(c, a, 2, 7.));
+    BOOST_CHECK(ends(sg.IncomingEdges(a)) == EdgeEnds({pair_ids(d, a), pair_ids(c, a)}));
+
+    BOOST_CHECK(sg.RemoveVertex(a));
+    BOOST_CHECK_EQUAL(sg.EdgeCount(), 0);
+    BOOST_CHECK(sg.IsVertexIsolated(c));
+    BOOST_CHECK(sg.IsVertexIsolated(d));
+    BOOST_CHECK(all_ends(sg).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -14,6 +14,9 @@
 #include "stages/simplification_pipeline/single_cell_simplification.hpp"
 #include "stages/simplification_pipeline/rna_simplification.hpp"
 #include "assembly_graph/stats/picture_dump.hpp"
+#include "adt/queue_iterator.hpp"
+
+#include <random>
 //#include "repeat_resolving_routine.hpp"
 
 namespace debruijn_graph {
@@ -413,6 +416,107 @@ BOOST_AUTO_TEST_CASE( ParallelECRemover2 ) {
     BOOST_CHECK_EQUAL(gp.g.size(), 20u);
 }
 
+std::multiset<std::string> EdgeSequences(const Graph &g) {
+    std::multiset<std::string> res;
+    for (auto it = g.ConstEdgeBegin(); !it.IsEnd(); ++it)
+        res.insert(g.EdgeNucls(*it).str());
+    return res;
+}
+
+std::multiset<std::string> ClipTipsBuffered(const std::string &path, size_t buff_size) {
+    Graph g(55);
+    graphio::ScanBasicGraph(path, g);
+    debruijn::simplification::TipClipperInstance(g, standard_tc_config(), standard_simplif_relevant_info(),
+                                                 (EdgeRemovalHandlerF<Graph>)nullptr, buff_size)->Run();
+    return EdgeSequences(g);
+}
+
+std::multiset<std::string> RemoveECBuffered(const std::string &path, const std::string &condition,
+                                            size_t buff_size) {
+    Graph g(55);
+    graphio::ScanBasicGraph(path, g);
+    debruijn_config::simplification::erroneous_connections_remover ec_config;
+    ec_config.condition = condition;
+    auto ec_remover_ptr = debruijn::simplification::ECRemoverInstance(g, ec_config, standard_simplif_relevant_info(),
+                                                                      (EdgeRemovalHandlerF<Graph>)nullptr, 2, buff_size);
+    ec_remover_ptr->Run();
+    ec_remover_ptr->Run();
+    return EdgeSequences(g);
+}
+
+BOOST_AUTO_TEST_CASE( BufferedTipClipper ) {
+    for (std::string path : {graph_fragment_root() + "simpliest_tip/simpliest_tip",
+                             graph_fragment_root() + "tipobulge/tipobulge",
+                             graph_fragment_root() + "tips/graph"}) {
+        auto expected = ClipTipsBuffered(path, 0);
+        for (size_t buff_size : {1, 2, 1000}) {
+            BOOST_CHECK(ClipTipsBuffered(path, buff_size) == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( BufferedECRemover ) {
+    std::vector<std::pair<std::string, std::string>> tests = {
+            {graph_fragment_root() + "topology_ec/iter_unique_path", "{ icb 7000 , ec_lb 20 }"},
+            {graph_fragment_root() + "complex_bulge/complex_bulge", "{ cb 1000 , ec_lb 20 }"}};
+    for (const auto &test : tests) {
+        auto expected = RemoveECBuffered(test.first, test.second, 0);
+        for (size_t buff_size : {1, 2, 1000}) {
+            BOOST_CHECK(RemoveECBuffered(test.first, test.second, buff_size) == expected);
+        }
+    }
+}
+
+//Counts calls for the elements that are not kept in the queue
+struct LiveKeysComparator {
+    const std::set<size_t> *live;
+    size_t *stale_calls;
+
+    bool operator()(size_t a, size_t b) const {
+        if (!live->count(a) || !live->count(b))
+            ++*stale_calls;
+        return a % 97 == b % 97 ? a < b : a % 97 < b % 97;
+    }
+};
+
+BOOST_AUTO_TEST_CASE( HeapQueueOrder ) {
+    std::set<size_t> live;
+    size_t stale_calls = 0;
+    LiveKeysComparator comparator{&live, &stale_calls};
+    erasable_priority_queue<size_t, LiveKeysComparator> set_queue(comparator);
+    erasable_heap_queue<size_t, LiveKeysComparator> heap_queue(comparator);
+    std::mt19937 rnd(42);
+    for (size_t i = 0; i < 100000; ++i) {
+        size_t key = rnd() % 1000;
+        switch (rnd() % 3) {
+            case 0:
+                live.insert(key);
+                set_queue.push(key);
+                heap_queue.push(key);
+                break;
+            case 1:
+                if (live.count(key)) {
+                    BOOST_CHECK(set_queue.erase(key));
+                    BOOST_CHECK(heap_queue.erase(key));
+                    live.erase(key);
+                } else {
+                    BOOST_CHECK(!heap_queue.erase(key));
+                }
+                break;
+            default:
+                if (!set_queue.empty()) {
+                    BOOST_CHECK_EQUAL(set_queue.top(), heap_queue.top());
+                    size_t top = set_queue.top();
+                    set_queue.pop();
+                    heap_queue.pop();
+                    live.erase(top);
+                }
+        }
+        BOOST_CHECK_EQUAL(set_queue.size(), heap_queue.size());
+    }
+    BOOST_CHECK_EQUAL(stale_calls, 0u);
+}
+
 //BOOST_AUTO_TEST_CASE( ComplexTipRemover ) {
 //    string path = "./src/test/debruijn/graph_fragments/ecs/graph";
 //    size_t graph_size = 0;
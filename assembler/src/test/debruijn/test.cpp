@@ -19,6 +19,8 @@
 #include "overlap_analysis_test.hpp"
 //#include "detail_coverage_test.hpp"
 #include "paired_info_test.hpp"
+#include "kmer_index_test.hpp"
+#include "long_read_storage_test.hpp"
 //fixme why is it disabled
 //#include "pair_info_test.hpp"
 